@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "binary_gcd.hpp"
+
+struct Operands {
+    const char* name;
+    std::vector<uint64_t> a;
+    std::vector<uint64_t> b;
+};
+
+static Operands make_small(std::mt19937_64& rng, size_t n) {
+    Operands ops{"малые дроби (< 2^16)", {}, {}};
+    std::uniform_int_distribution<uint64_t> dist(1, 1 << 16);
+    for (size_t i = 0; i < n; ++i) {
+        ops.a.push_back(dist(rng));
+        ops.b.push_back(dist(rng));
+    }
+    return ops;
+}
+
+static Operands make_sum_results(std::mt19937_64& rng, size_t n) {
+    // Числитель и знаменатель суммы двух дробей со знаменателями < 2^32.
+    Operands ops{"результаты сложения (~2^32..2^63)", {}, {}};
+    std::uniform_int_distribution<uint64_t> dist(1, 0xFFFFFFFFu);
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t n1 = dist(rng) >> 1, d1 = dist(rng), n2 = dist(rng) >> 1, d2 = dist(rng);
+        ops.a.push_back(n1 * d2 + n2 * d1);
+        ops.b.push_back(d1 * d2);
+    }
+    return ops;
+}
+
+static Operands make_large(std::mt19937_64& rng, size_t n) {
+    Operands ops{"большие случайные (< 2^63)", {}, {}};
+    for (size_t i = 0; i < n; ++i) {
+        ops.a.push_back((rng() >> 1) | 1);
+        ops.b.push_back(rng() >> 1);
+    }
+    return ops;
+}
+
+static Operands make_fibonacci(size_t n) {
+    // Соседние числа Фибоначчи — худший случай для алгоритма Евклида.
+    Operands ops{"соседние числа Фибоначчи", {}, {}};
+    std::vector<uint64_t> fib{1, 2};
+    while (fib.back() < (uint64_t(1) << 62)) fib.push_back(fib[fib.size() - 1] + fib[fib.size() - 2]);
+    for (size_t i = 0; i < n; ++i) {
+        size_t k = 1 + i % (fib.size() - 1);
+        ops.a.push_back(fib[k]);
+        ops.b.push_back(fib[k - 1]);
+    }
+    return ops;
+}
+
+template <typename Gcd>
+static double measure(const Operands& ops, Gcd gcd, uint64_t& checksum) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < ops.a.size(); ++i) {
+        sum += gcd(ops.a[i], ops.b[i]);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    checksum = sum;
+    return std::chrono::duration<double, std::nano>(stop - start).count() / ops.a.size();
+}
+
+int main() {
+    const size_t count = 1 << 20;
+    std::mt19937_64 rng(2211);
+
+    std::vector<Operands> sets;
+    sets.push_back(make_small(rng, count));
+    sets.push_back(make_sum_results(rng, count));
+    sets.push_back(make_large(rng, count));
+    sets.push_back(make_fibonacci(count));
+
+    std::printf("%12s %12s  %s\n", "std::gcd", "binary_gcd", "распределение");
+    for (const Operands& ops : sets) {
+        uint64_t std_sum, bin_sum;
+        double std_ns = measure(ops, [](uint64_t a, uint64_t b) { return std::gcd(a, b); }, std_sum);
+        double bin_ns = measure(ops, [](uint64_t a, uint64_t b) { return binary_gcd(a, b); }, bin_sum);
+        std::printf("%9.2f нс %9.2f нс  %s%s\n", std_ns, bin_ns, ops.name,
+                    std_sum == bin_sum ? "" : " (результаты расходятся!)");
+    }
+    return 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Не даёт компилятору выбросить вычисление значения.
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<const volatile char*>(&value);
+#endif
+}
+
+// Прогоняет body(i) для i = 0..iterations-1 несколько раз и печатает
+// лучшее время на одну итерацию.
+template <typename Body>
+inline double run_benchmark(const char* name, size_t iterations, Body body) {
+    const int repeats = 5;
+    double best = 0;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            body(i);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+        if (r == 0 || ns < best) best = ns;
+    }
+    std::printf("%10.2f нс  %s\n", best, name);
+    return best;
+}
@@ -0,0 +1,203 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "harness.hpp"
+#include "rational.hpp"
+#include "rational_expr.hpp"
+
+namespace {
+
+const size_t operand_count = 4096;
+const size_t iterations = 1 << 18;
+
+struct RawSet {
+    const char* name;
+    std::vector<int64_t> numerators;
+    std::vector<int64_t> denominators;
+};
+
+struct PairSet {
+    const char* name;
+    std::vector<Rational> a;
+    std::vector<Rational> b;
+};
+
+int64_t uniform(std::mt19937_64& rng, int64_t lo, int64_t hi) {
+    return std::uniform_int_distribution<int64_t>(lo, hi)(rng);
+}
+
+// Случайное нечётное число порядка 2^bits; такие знаменатели почти всегда взаимно просты.
+int64_t odd(std::mt19937_64& rng, int bits) {
+    return uniform(rng, int64_t(1) << (bits - 1), (int64_t(1) << bits) - 1) | 1;
+}
+
+std::vector<RawSet> make_raw_sets(std::mt19937_64& rng) {
+    std::vector<RawSet> sets(4);
+    sets[0].name = "малые";
+    sets[1].name = "большие взаимно простые";
+    sets[2].name = "у границы переполнения";
+    sets[3].name = "16 повторяющихся пар";
+    for (size_t i = 0; i < operand_count; ++i) {
+        int64_t g = uniform(rng, 1, 64);
+        sets[0].numerators.push_back(g * uniform(rng, -1000, 1000));
+        sets[0].denominators.push_back(g * uniform(rng, 1, 1000));
+
+        sets[1].numerators.push_back(odd(rng, 61));
+        sets[1].denominators.push_back(odd(rng, 62));
+
+        int64_t k = uniform(rng, 2, 1 << 20);
+        sets[2].numerators.push_back(INT64_MAX / k * k);
+        sets[2].denominators.push_back(INT64_MAX - uniform(rng, 0, 1 << 20));
+    }
+
+    // Несколько пар с большим общим множителем, повторяющихся вразброс.
+    for (size_t i = 0; i < 16; ++i) {
+        int64_t g = odd(rng, 20);
+        sets[3].numerators.push_back(g * odd(rng, 40));
+        sets[3].denominators.push_back(g * odd(rng, 40));
+    }
+    for (size_t i = 16; i < operand_count; ++i) {
+        size_t k = static_cast<size_t>(uniform(rng, 0, 15));
+        sets[3].numerators.push_back(sets[3].numerators[k]);
+        sets[3].denominators.push_back(sets[3].denominators[k]);
+    }
+    return sets;
+}
+
+std::vector<PairSet> make_pair_sets(std::mt19937_64& rng) {
+    std::vector<PairSet> sets(4);
+    sets[0].name = "быстрый путь";
+    sets[1].name = "add_safe";
+    sets[2].name = "сокращение крест-накрест";
+    sets[3].name = "у границы переполнения";
+    for (size_t i = 0; i < operand_count; ++i) {
+        sets[0].a.push_back(Rational(uniform(rng, -1000, 1000), uniform(rng, 1, 1000)));
+        sets[0].b.push_back(Rational(uniform(rng, -1000, 1000), uniform(rng, 1, 1000)));
+
+        // Произведение знаменателей не помещается в 64 бита, а их НОК помещается.
+        int64_t common = odd(rng, 34);
+        sets[1].a.push_back(Rational(uniform(rng, -1000, 1000), common * odd(rng, 12)));
+        sets[1].b.push_back(Rational(uniform(rng, -1000, 1000), common * odd(rng, 12)));
+
+        // Произведения переполняются, но после сокращения a.num с b.den и b.num с a.den помещаются.
+        int64_t g1 = odd(rng, 40), g2 = odd(rng, 40);
+        sets[2].a.push_back(Rational(g1 * uniform(rng, 1, 1000), g2 * 3));
+        sets[2].b.push_back(Rational(g2 * uniform(rng, 1, 1000), g1 * 7));
+
+        sets[3].a.push_back(Rational(INT64_MAX - uniform(rng, 0, 1 << 20), odd(rng, 62)));
+        sets[3].b.push_back(Rational(INT64_MIN + 1 + uniform(rng, 0, 1 << 20), odd(rng, 62)));
+    }
+    return sets;
+}
+
+std::string label(const char* op, const char* set) {
+    return std::string(op) + " [" + set + "]";
+}
+
+template <typename Op>
+void bench_binary(const char* op, const PairSet& set, Op fn) {
+    run_benchmark(label(op, set.name).c_str(), iterations, [&](size_t i) {
+        size_t k = i % operand_count;
+        do_not_optimize(fn(set.a[k], set.b[k]));
+    });
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(2211);
+    std::vector<RawSet> raw_sets = make_raw_sets(rng);
+    std::vector<PairSet> pair_sets = make_pair_sets(rng);
+
+    std::printf("Конструирование и сокращение\n");
+    for (const RawSet& set : raw_sets) {
+        run_benchmark(label("Rational(n, d)", set.name).c_str(), iterations, [&](size_t i) {
+            size_t k = i % operand_count;
+            do_not_optimize(Rational(set.numerators[k], set.denominators[k]));
+        });
+
+        Rational::reset_reduce_cache();
+        run_benchmark(label("Rational::cached(n, d)", set.name).c_str(), iterations, [&](size_t i) {
+            size_t k = i % operand_count;
+            do_not_optimize(Rational::cached(set.numerators[k], set.denominators[k]));
+        });
+        ReduceCacheStats stats = Rational::reduce_cache_stats();
+        std::printf("%10.1f %%  попаданий в кеш\n", 100.0 * stats.hits / (stats.hits + stats.misses));
+    }
+
+    std::printf("\nАрифметика\n");
+    for (const PairSet& set : pair_sets) {
+        bench_binary("a + b", set, [](const Rational& a, const Rational& b) { return a + b; });
+        bench_binary("a - b", set, [](const Rational& a, const Rational& b) { return a - b; });
+        bench_binary("a * b", set, [](const Rational& a, const Rational& b) { return a * b; });
+        bench_binary("a / b", set, [](const Rational& a, const Rational& b) { return a / b; });
+    }
+
+    std::printf("\nАрифметика с целым\n");
+    for (const PairSet& set : pair_sets) {
+        bench_binary("a + Rational(3)", set, [](const Rational& a, const Rational&) { return a + Rational(3); });
+        bench_binary("a + 3", set, [](const Rational& a, const Rational&) { return a + 3; });
+        bench_binary("a * Rational(3)", set, [](const Rational& a, const Rational&) { return a * Rational(3); });
+        bench_binary("a * 3", set, [](const Rational& a, const Rational&) { return a * 3; });
+        bench_binary("a / 3", set, [](const Rational& a, const Rational&) { return a / 3; });
+        bench_binary("a < 3", set, [](const Rational& a, const Rational&) { return a < 3; });
+    }
+
+    std::printf("\nВыражения\n");
+    for (const PairSet& set : pair_sets) {
+        run_benchmark(label("a*b + c*d - e", set.name).c_str(), iterations, [&](size_t i) {
+            size_t k = i % operand_count, m = (i + 1) % operand_count;
+            do_not_optimize(set.a[k] * set.b[k] + set.a[m] * set.b[m] - set.a[(i + 2) % operand_count]);
+        });
+        run_benchmark(label("fused: a*b + c*d - e", set.name).c_str(), iterations, [&](size_t i) {
+            size_t k = i % operand_count, m = (i + 1) % operand_count;
+            Rational value = fused(set.a[k]) * set.b[k] + fused(set.a[m]) * set.b[m] - set.a[(i + 2) % operand_count];
+            do_not_optimize(value);
+        });
+    }
+
+    std::printf("\nСравнения\n");
+    for (const PairSet& set : pair_sets) {
+        bench_binary("a == b", set, [](const Rational& a, const Rational& b) { return a == b; });
+        bench_binary("a != b", set, [](const Rational& a, const Rational& b) { return a != b; });
+        bench_binary("a < b", set, [](const Rational& a, const Rational& b) { return a < b; });
+        bench_binary("a <= b", set, [](const Rational& a, const Rational& b) { return a <= b; });
+        bench_binary("a > b", set, [](const Rational& a, const Rational& b) { return a > b; });
+        bench_binary("a >= b", set, [](const Rational& a, const Rational& b) { return a >= b; });
+    }
+
+    std::printf("\nПреобразования\n");
+    for (const PairSet& set : pair_sets) {
+        run_benchmark(label("str()", set.name).c_str(), iterations, [&](size_t i) {
+            std::string text = set.a[i % operand_count].str();
+            do_not_optimize(text.size());
+        });
+        run_benchmark(label("to_chars()", set.name).c_str(), iterations, [&](size_t i) {
+            char buffer[Rational::max_chars];
+            std::to_chars_result result = set.a[i % operand_count].to_chars(buffer, buffer + Rational::max_chars);
+            do_not_optimize(result.ptr);
+        });
+        run_benchmark(label("double", set.name).c_str(), iterations, [&](size_t i) {
+            do_not_optimize(static_cast<double>(set.a[i % operand_count]));
+        });
+        run_benchmark(label("to_double()", set.name).c_str(), iterations, [&](size_t i) {
+            do_not_optimize(set.a[i % operand_count].to_double());
+        });
+        run_benchmark(label("from_double(x, 10^6)", set.name).c_str(), iterations, [&](size_t i) {
+            Rational value;
+            Rational::from_double(static_cast<double>(set.a[i % operand_count]), 1000000, value);
+            do_not_optimize(value);
+        });
+        run_benchmark(label("limit_denominator(2^31 - 1)", set.name).c_str(), iterations, [&](size_t i) {
+            do_not_optimize(set.a[i % operand_count].limit_denominator(INT32_MAX));
+        });
+        run_benchmark(label("round_to(1000)", set.name).c_str(), iterations, [&](size_t i) {
+            do_not_optimize(set.a[i % operand_count].round_to(1000));
+        });
+        run_benchmark(label("floor()", set.name).c_str(), iterations, [&](size_t i) {
+            do_not_optimize(set.a[i % operand_count].floor());
+        });
+    }
+    return 0;
+}
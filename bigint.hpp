@@ -0,0 +1,440 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <memory_resource>
+
+// Целое произвольной длины: знак и модуль из 32-битных разрядов, младшие первыми.
+// Числа до inline_limbs разрядов (128 бит) хранятся внутри объекта без выделения памяти,
+// более длинные — в памяти из ресурса allocator; результаты операций берут ресурс
+// левого операнда.
+class BigInt {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+private:
+    static constexpr size_t inline_limbs = 4;
+
+    uint32_t inline_[inline_limbs] = {};
+    std::pmr::vector<uint32_t> heap_;
+    size_t size_ = 0;
+    bool negative_ = false;
+
+    uint32_t* data() { return heap_.empty() ? inline_ : heap_.data(); }
+    const uint32_t* data() const { return heap_.empty() ? inline_ : heap_.data(); }
+
+    void resize(size_t n) {
+        if (heap_.empty() && n > inline_limbs) {
+            std::pmr::vector<uint32_t> heap(n, 0, heap_.get_allocator());
+            std::copy(inline_, inline_ + size_, heap.begin());
+            heap_.swap(heap);
+        } else if (!heap_.empty() && heap_.size() < n) {
+            heap_.resize(n, 0);
+        }
+
+        uint32_t* limbs = data();
+        for (size_t i = size_; i < n; ++i) limbs[i] = 0;
+        size_ = n;
+    }
+
+    void trim() {
+        const uint32_t* limbs = data();
+        while (size_ > 0 && limbs[size_ - 1] == 0) --size_;
+        if (size_ == 0) negative_ = false;
+    }
+
+    void assign_magnitude(uint64_t mag) {
+        size_ = 0;
+        resize(2);
+        data()[0] = static_cast<uint32_t>(mag);
+        data()[1] = static_cast<uint32_t>(mag >> 32);
+        trim();
+    }
+
+    static int compare_magnitude(const BigInt& a, const BigInt& b) {
+        if (a.size_ != b.size_) return a.size_ < b.size_ ? -1 : 1;
+        const uint32_t* x = a.data();
+        const uint32_t* y = b.data();
+        for (size_t i = a.size_; i-- > 0;) {
+            if (x[i] != y[i]) return x[i] < y[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    static BigInt add_magnitude(const BigInt& a, const BigInt& b) {
+        const BigInt& longer = a.size_ >= b.size_ ? a : b;
+        const BigInt& shorter = a.size_ >= b.size_ ? b : a;
+
+        BigInt result(a.get_allocator());
+        result.resize(longer.size_ + 1);
+        uint32_t* r = result.data();
+        const uint32_t* x = longer.data();
+        const uint32_t* y = shorter.data();
+
+        uint64_t carry = 0;
+        for (size_t i = 0; i < longer.size_; ++i) {
+            uint64_t sum = static_cast<uint64_t>(x[i]) + (i < shorter.size_ ? y[i] : 0) + carry;
+            r[i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+        }
+        r[longer.size_] = static_cast<uint32_t>(carry);
+        result.trim();
+        return result;
+    }
+
+    // |a| >= |b|; результат в ресурсе allocator.
+    static BigInt sub_magnitude(const BigInt& a, const BigInt& b, const allocator_type& allocator) {
+        BigInt result(allocator);
+        result.resize(a.size_);
+        uint32_t* r = result.data();
+        const uint32_t* x = a.data();
+        const uint32_t* y = b.data();
+
+        int64_t borrow = 0;
+        for (size_t i = 0; i < a.size_; ++i) {
+            int64_t diff = static_cast<int64_t>(x[i]) - (i < b.size_ ? y[i] : 0) - borrow;
+            borrow = diff < 0;
+            r[i] = static_cast<uint32_t>(diff + (borrow << 32));
+        }
+        result.trim();
+        return result;
+    }
+
+    static BigInt add_signed(const BigInt& a, const BigInt& b, bool b_negative) {
+        if (a.negative_ == b_negative) {
+            BigInt result = add_magnitude(a, b);
+            result.negative_ = a.negative_ && result.size_ != 0;
+            return result;
+        }
+
+        if (compare_magnitude(a, b) >= 0) {
+            BigInt result = sub_magnitude(a, b, a.get_allocator());
+            result.negative_ = a.negative_ && result.size_ != 0;
+            return result;
+        }
+
+        BigInt result = sub_magnitude(b, a, a.get_allocator());
+        result.negative_ = b_negative && result.size_ != 0;
+        return result;
+    }
+
+    // Деление модулей (алгоритм D из Кнута): q = |u| / |v|, r = |u| % |v|.
+    static void divmod_magnitude(const BigInt& u, const BigInt& v, BigInt& q, BigInt& r) {
+        if (compare_magnitude(u, v) < 0) {
+            q = BigInt();
+            r = u;
+            r.negative_ = false;
+            return;
+        }
+
+        size_t m = u.size_;
+        size_t n = v.size_;
+        q = BigInt();
+        q.resize(m - n + 1);
+        uint32_t* qd = q.data();
+
+        if (n == 1) {
+            uint64_t divisor = v.data()[0];
+            uint64_t rem = 0;
+            const uint32_t* ud = u.data();
+            for (size_t i = m; i-- > 0;) {
+                uint64_t cur = (rem << 32) | ud[i];
+                qd[i] = static_cast<uint32_t>(cur / divisor);
+                rem = cur % divisor;
+            }
+            q.trim();
+            r = BigInt();
+            r.assign_magnitude(rem);
+            return;
+        }
+
+        int shift = std::countl_zero(v.data()[n - 1]);
+        std::pmr::vector<uint32_t> vn(n, u.get_allocator()), un(m + 1, u.get_allocator());
+        const uint32_t* vd = v.data();
+        const uint32_t* ud = u.data();
+        for (size_t i = n - 1; i > 0; --i) {
+            vn[i] = (vd[i] << shift) | (shift ? vd[i - 1] >> (32 - shift) : 0);
+        }
+        vn[0] = vd[0] << shift;
+        un[m] = shift ? ud[m - 1] >> (32 - shift) : 0;
+        for (size_t i = m - 1; i > 0; --i) {
+            un[i] = (ud[i] << shift) | (shift ? ud[i - 1] >> (32 - shift) : 0);
+        }
+        un[0] = ud[0] << shift;
+
+        const uint64_t base = uint64_t(1) << 32;
+        for (size_t j = m - n + 1; j-- > 0;) {
+            uint64_t top = (static_cast<uint64_t>(un[j + n]) << 32) | un[j + n - 1];
+            uint64_t qhat = top / vn[n - 1];
+            uint64_t rhat = top % vn[n - 1];
+            while (qhat >= base || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+                --qhat;
+                rhat += vn[n - 1];
+                if (rhat >= base) break;
+            }
+
+            int64_t borrow = 0;
+            int64_t t;
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t p = qhat * vn[i];
+                t = static_cast<int64_t>(un[i + j]) - borrow - static_cast<int64_t>(p & 0xFFFFFFFFu);
+                un[i + j] = static_cast<uint32_t>(t);
+                borrow = static_cast<int64_t>(p >> 32) - (t >> 32);
+            }
+            t = static_cast<int64_t>(un[j + n]) - borrow;
+            un[j + n] = static_cast<uint32_t>(t);
+
+            qd[j] = static_cast<uint32_t>(qhat);
+            if (t < 0) {
+                --qd[j];
+                uint64_t carry = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    uint64_t sum = static_cast<uint64_t>(un[i + j]) + vn[i] + carry;
+                    un[i + j] = static_cast<uint32_t>(sum);
+                    carry = sum >> 32;
+                }
+                un[j + n] += static_cast<uint32_t>(carry);
+            }
+        }
+        q.trim();
+
+        r = BigInt();
+        r.resize(n);
+        uint32_t* rd = r.data();
+        for (size_t i = 0; i < n; ++i) {
+            rd[i] = (un[i] >> shift) | (shift ? un[i + 1] << (32 - shift) : 0);
+        }
+        r.trim();
+    }
+
+    // Делит модуль на небольшое число на месте и возвращает остаток.
+    uint32_t divmod_small(uint32_t divisor) {
+        uint32_t* limbs = data();
+        uint64_t rem = 0;
+        for (size_t i = size_; i-- > 0;) {
+            uint64_t cur = (rem << 32) | limbs[i];
+            limbs[i] = static_cast<uint32_t>(cur / divisor);
+            rem = cur % divisor;
+        }
+        trim();
+        return static_cast<uint32_t>(rem);
+    }
+
+public:
+    BigInt() {}
+
+    explicit BigInt(const allocator_type& allocator) : heap_(allocator) {}
+
+    BigInt(int64_t value, const allocator_type& allocator = {}) : heap_(allocator) {
+        negative_ = value < 0;
+        assign_magnitude(negative_ ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value));
+    }
+
+    static BigInt from_unsigned(uint64_t value, const allocator_type& allocator = {}) {
+        BigInt result(allocator);
+        result.assign_magnitude(value);
+        return result;
+    }
+
+    // Копия остаётся в ресурсе оригинала; перенести число в другой ресурс можно
+    // конструкторами с allocator.
+    BigInt(const BigInt& other) : BigInt(other, other.get_allocator()) {}
+
+    BigInt(const BigInt& other, const allocator_type& allocator)
+        : heap_(other.heap_, allocator), size_(other.size_), negative_(other.negative_) {
+        std::copy(other.inline_, other.inline_ + inline_limbs, inline_);
+    }
+
+    // Присваивание оставляет число в его прежнем ресурсе.
+    BigInt& operator=(const BigInt& other) = default;
+
+    BigInt(BigInt&& other) noexcept
+        : heap_(std::move(other.heap_)), size_(other.size_), negative_(other.negative_) {
+        std::copy(other.inline_, other.inline_ + inline_limbs, inline_);
+        other.heap_.clear();
+        other.size_ = 0;
+        other.negative_ = false;
+    }
+
+    BigInt(BigInt&& other, const allocator_type& allocator)
+        : heap_(std::move(other.heap_), allocator), size_(other.size_), negative_(other.negative_) {
+        std::copy(other.inline_, other.inline_ + inline_limbs, inline_);
+        other.heap_.clear();
+        other.size_ = 0;
+        other.negative_ = false;
+    }
+
+    BigInt& operator=(BigInt&& other) noexcept {
+        if (this != &other) {
+            heap_ = std::move(other.heap_);
+            std::copy(other.inline_, other.inline_ + inline_limbs, inline_);
+            size_ = other.size_;
+            negative_ = other.negative_;
+            other.heap_.clear();
+            other.size_ = 0;
+            other.negative_ = false;
+        }
+        return *this;
+    }
+
+    bool is_zero() const { return size_ == 0; }
+    bool is_negative() const { return negative_; }
+    bool is_inline() const { return heap_.empty(); }
+
+    allocator_type get_allocator() const { return heap_.get_allocator(); }
+
+    BigInt abs() const {
+        BigInt result = *this;
+        result.negative_ = false;
+        return result;
+    }
+
+    // Записывает значение в out, если оно помещается в int64_t.
+    bool to_int64(int64_t& out) const {
+        if (size_ > 2) return false;
+        const uint32_t* limbs = data();
+        uint64_t mag = (size_ > 0 ? limbs[0] : 0) | (size_ > 1 ? static_cast<uint64_t>(limbs[1]) << 32 : 0);
+        uint64_t limit = static_cast<uint64_t>(INT64_MAX) + (negative_ ? 1 : 0);
+        if (mag > limit) return false;
+        out = negative_ ? static_cast<int64_t>(0 - mag) : static_cast<int64_t>(mag);
+        return true;
+    }
+
+    // Младшие 64 бита значения в дополнительном коде, как у приведения
+    // int128_t к uint64_t.
+    uint64_t low_bits() const {
+        const uint32_t* limbs = data();
+        uint64_t mag = (size_ > 0 ? limbs[0] : 0) | (size_ > 1 ? static_cast<uint64_t>(limbs[1]) << 32 : 0);
+        return negative_ ? 0 - mag : mag;
+    }
+
+    // Возвращает m и exponent такие, что значение примерно равно m * 2^exponent.
+    double to_double_scaled(int64_t& exponent) const {
+        const uint32_t* limbs = data();
+        double mantissa = 0;
+        size_t used = std::min<size_t>(size_, 3);
+        for (size_t i = 0; i < used; ++i) {
+            mantissa = mantissa * 4294967296.0 + limbs[size_ - 1 - i];
+        }
+        exponent = static_cast<int64_t>(size_ - used) * 32;
+        return negative_ ? -mantissa : mantissa;
+    }
+
+    explicit operator double() const {
+        int64_t exponent;
+        double mantissa = to_double_scaled(exponent);
+        return std::ldexp(mantissa, static_cast<int>(std::min<int64_t>(exponent, 1 << 20)));
+    }
+
+    std::string str() const {
+        if (size_ == 0) return "0";
+
+        BigInt rest = abs();
+        std::string digits;
+        while (!rest.is_zero()) {
+            uint32_t chunk = rest.divmod_small(1000000000u);
+            for (int i = 0; i < 9; ++i) {
+                digits.push_back(static_cast<char>('0' + chunk % 10));
+                chunk /= 10;
+                if (rest.is_zero() && chunk == 0) break;
+            }
+        }
+        if (negative_) digits.push_back('-');
+        std::reverse(digits.begin(), digits.end());
+        return digits;
+    }
+
+    BigInt operator-() const {
+        BigInt result = *this;
+        result.negative_ = !negative_ && size_ != 0;
+        return result;
+    }
+
+    BigInt operator+(const BigInt& other) const {
+        return add_signed(*this, other, other.negative_);
+    }
+
+    BigInt operator-(const BigInt& other) const {
+        return add_signed(*this, other, !other.negative_ && other.size_ != 0);
+    }
+
+    BigInt operator*(const BigInt& other) const {
+        if (size_ == 0 || other.size_ == 0) return BigInt(get_allocator());
+
+        BigInt result(get_allocator());
+        result.resize(size_ + other.size_);
+        uint32_t* r = result.data();
+        const uint32_t* x = data();
+        const uint32_t* y = other.data();
+        for (size_t i = 0; i < size_; ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < other.size_; ++j) {
+                uint64_t cur = static_cast<uint64_t>(x[i]) * y[j] + r[i + j] + carry;
+                r[i + j] = static_cast<uint32_t>(cur);
+                carry = cur >> 32;
+            }
+            r[i + other.size_] = static_cast<uint32_t>(carry);
+        }
+        result.negative_ = negative_ != other.negative_;
+        result.trim();
+        return result;
+    }
+
+    // Деление с отбрасыванием дробной части, как для встроенных целых.
+    BigInt operator/(const BigInt& other) const {
+        BigInt q(get_allocator()), r(get_allocator());
+        divmod_magnitude(*this, other, q, r);
+        q.negative_ = (negative_ != other.negative_) && q.size_ != 0;
+        return q;
+    }
+
+    BigInt operator%(const BigInt& other) const {
+        BigInt q(get_allocator()), r(get_allocator());
+        divmod_magnitude(*this, other, q, r);
+        r.negative_ = negative_ && r.size_ != 0;
+        return r;
+    }
+
+    static BigInt gcd(BigInt a, BigInt b) {
+        a.negative_ = false;
+        b.negative_ = false;
+        while (!b.is_zero()) {
+            BigInt q(a.get_allocator()), r(a.get_allocator());
+            divmod_magnitude(a, b, q, r);
+            a = std::move(b);
+            b = std::move(r);
+        }
+        return a;
+    }
+
+    bool operator==(const BigInt& other) const {
+        return negative_ == other.negative_ && compare_magnitude(*this, other) == 0;
+    }
+
+    bool operator!=(const BigInt& other) const {
+        return !(*this == other);
+    }
+
+    bool operator<(const BigInt& other) const {
+        if (negative_ != other.negative_) return negative_;
+        int cmp = compare_magnitude(*this, other);
+        return negative_ ? cmp > 0 : cmp < 0;
+    }
+
+    bool operator<=(const BigInt& other) const {
+        return !(other < *this);
+    }
+
+    bool operator>(const BigInt& other) const {
+        return other < *this;
+    }
+
+    bool operator>=(const BigInt& other) const {
+        return !(*this < other);
+    }
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include "rational_counters.hpp"
+
+#if !defined(RATIONAL_NO_CTZ_BUILTINS) && (defined(__GNUC__) || defined(__clang__))
+#define RATIONAL_HAS_CTZ_BUILTINS 1
+#endif
+
+// Количество младших нулевых битов; x != 0.
+constexpr int ctz64(uint64_t x) {
+#ifdef RATIONAL_HAS_CTZ_BUILTINS
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// Алгоритм Штейна: только сдвиги и вычитания, без аппаратного деления.
+constexpr uint64_t binary_gcd(uint64_t a, uint64_t b) {
+    if (a == 0) return b;
+    if (b == 0) return a;
+
+    int shift = ctz64(a | b);
+    a >>= ctz64(a);
+    b >>= ctz64(b);
+    while (a != b) {
+        RATIONAL_COUNT(gcd_iterations);
+        uint64_t low = a < b ? a : b;
+        uint64_t diff = a < b ? b - a : a - b;
+        a = low;
+        b = diff >> ctz64(diff);
+    }
+    return a << shift;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace checked {
+
+#if !defined(RATIONAL_NO_OVERFLOW_BUILTINS) && (defined(__GNUC__) || defined(__clang__))
+#define RATIONAL_HAS_OVERFLOW_BUILTINS 1
+#endif
+
+namespace detail {
+
+template <typename T>
+constexpr uint64_t magnitude(T v, bool& negative) {
+    if constexpr (std::is_signed_v<T>) {
+        negative = v < 0;
+        return negative ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+    } else {
+        negative = false;
+        return static_cast<uint64_t>(v);
+    }
+}
+
+constexpr bool umul(uint64_t a, uint64_t b, uint64_t& out) {
+    uint64_t a_hi = a >> 32, b_hi = b >> 32;
+    if (a_hi != 0 && b_hi != 0) return true;
+
+    uint64_t a_lo = a & 0xFFFFFFFFu, b_lo = b & 0xFFFFFFFFu;
+    uint64_t cross = a_hi * b_lo + a_lo * b_hi;
+    if (cross >> 32) return true;
+
+    uint64_t low = a_lo * b_lo;
+    out = low + (cross << 32);
+    return out < low;
+}
+
+template <typename R>
+constexpr bool narrow(uint64_t mag, bool negative, R& out) {
+    if constexpr (std::is_signed_v<R>) {
+        uint64_t limit = static_cast<uint64_t>(std::numeric_limits<R>::max()) + (negative ? 1 : 0);
+        if (mag > limit) return true;
+        out = negative ? static_cast<R>(0 - mag) : static_cast<R>(mag);
+    } else {
+        if (negative && mag != 0) return true;
+        if (mag > std::numeric_limits<R>::max()) return true;
+        out = static_cast<R>(mag);
+    }
+    return false;
+}
+
+} // namespace detail
+
+// Возвращают true при переполнении, иначе записывают результат в out.
+template <typename A, typename B, typename R>
+constexpr bool mul(A a, B b, R& out) {
+#ifdef RATIONAL_HAS_OVERFLOW_BUILTINS
+    return __builtin_mul_overflow(a, b, &out);
+#else
+    bool neg_a, neg_b;
+    uint64_t mag;
+    if (detail::umul(detail::magnitude(a, neg_a), detail::magnitude(b, neg_b), mag)) return true;
+    return detail::narrow(mag, neg_a != neg_b, out);
+#endif
+}
+
+constexpr bool add(int64_t a, int64_t b, int64_t& out) {
+#ifdef RATIONAL_HAS_OVERFLOW_BUILTINS
+    return __builtin_add_overflow(a, b, &out);
+#else
+    out = static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+    return ((a ^ out) & (b ^ out)) < 0;
+#endif
+}
+
+constexpr bool sub(int64_t a, int64_t b, int64_t& out) {
+#ifdef RATIONAL_HAS_OVERFLOW_BUILTINS
+    return __builtin_sub_overflow(a, b, &out);
+#else
+    out = static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+    return ((a ^ b) & (a ^ out)) < 0;
+#endif
+}
+
+constexpr bool add(uint64_t a, uint64_t b, uint64_t& out) {
+#ifdef RATIONAL_HAS_OVERFLOW_BUILTINS
+    return __builtin_add_overflow(a, b, &out);
+#else
+    out = a + b;
+    return out < a;
+#endif
+}
+
+} // namespace checked
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "rational.hpp"
+#include "packed_rational.hpp"
+#include "exact_rational.hpp"
+
+// Сумма, в которую одновременно добавляют значения многие потоки. Каждый поток
+// пишет в свой шард (шардов не меньше, чем ядер), шарды складываются только при
+// чтении. В шарде значение хранится в 8-байтовой упакованной форме
+// PackedRational в одном атомарном слове и обновляется без блокировок через
+// compare_exchange; то, что в эту форму не помещается, точно накапливается в
+// ExactRational под мьютексом шарда. Когда сумма в слове подходит к границе
+// упакованной формы, она переносится в ExactRational, а слово обнуляется, чтобы
+// следующие добавления снова шли без блокировок.
+class ConcurrentRationalSum {
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> packed{PackedRational::pack(0, 1)};
+        std::mutex mutex;
+        ExactRational overflow;
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t mask_;
+
+    // Потоки получают номера по очереди, поэтому первые потоки попадают в разные шарды.
+    static size_t thread_index() {
+        static std::atomic<size_t> next{0};
+        thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    static Rational unpack(uint64_t bits) {
+        Rational result;
+        result.numerator_ = static_cast<int32_t>(static_cast<uint32_t>(bits >> 32));
+        result.denominator_ = (bits >> 1) & 0x7FFFFFFFu;
+        return result;
+    }
+
+    // Оба слагаемых меньше 2^31 по модулю, поэтому сумма считается в 64 битах без проверок.
+    static bool try_add_packed(std::atomic<uint64_t>& word, const Rational& value) {
+        uint64_t bits = word.load(std::memory_order_relaxed);
+        for (;;) {
+            Rational current = unpack(bits);
+            int64_t num = current.numerator_ * static_cast<int64_t>(value.denominator_) +
+                          value.numerator_ * static_cast<int64_t>(current.denominator_);
+            uint64_t den = current.denominator_ * value.denominator_;
+            if (num == 0) {
+                den = 1;
+            } else {
+                uint64_t gcd_val = binary_gcd(Rational::abs_value(num), den);
+                num /= static_cast<int64_t>(gcd_val);
+                den /= gcd_val;
+            }
+            if (!PackedRational::fits_packed(num, den)) return false;
+
+            if (word.compare_exchange_weak(bits, PackedRational::pack(num, den), std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+public:
+    // shards = 0 — по степени двойки не меньше числа ядер.
+    explicit ConcurrentRationalSum(size_t shards = 0) {
+        if (shards == 0) shards = std::max<unsigned>(1, std::thread::hardware_concurrency());
+        shards = std::bit_ceil(shards);
+        shards_ = std::make_unique<Shard[]>(shards);
+        mask_ = shards - 1;
+    }
+
+    ConcurrentRationalSum(const ConcurrentRationalSum&) = delete;
+    ConcurrentRationalSum& operator=(const ConcurrentRationalSum&) = delete;
+
+    // Добавляет value или, при subtract, -value: -INT64_MIN не представим в
+    // Rational, но точно вычитается в ExactRational.
+    void add(const Rational& value, bool subtract) {
+        Shard& shard = shards_[thread_index() & mask_];
+        bool packable = PackedRational::fits_packed(value.numerator_, value.denominator_);
+        if (packable && try_add_packed(shard.packed, subtract ? -value : value)) return;
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (packable) {
+            uint64_t drained = shard.packed.exchange(PackedRational::pack(0, 1), std::memory_order_relaxed);
+            shard.overflow += ExactRational(unpack(drained));
+        }
+        if (subtract) {
+            shard.overflow -= ExactRational(value);
+        } else {
+            shard.overflow += ExactRational(value);
+        }
+    }
+
+    void add(const Rational& value) {
+        add(value, false);
+    }
+
+    void subtract(const Rational& value) {
+        add(value, true);
+    }
+
+    ConcurrentRationalSum& operator+=(const Rational& value) {
+        add(value);
+        return *this;
+    }
+
+    ConcurrentRationalSum& operator-=(const Rational& value) {
+        subtract(value);
+        return *this;
+    }
+
+    // Точная несократимая сумма. Добавления, идущие одновременно с чтением,
+    // могут попасть в неё частично. Слово шарда читается под мьютексом, иначе
+    // перенос его в overflow между двумя чтениями посчитал бы значение дважды.
+    ExactRational total() const {
+        ExactRational result;
+        for (size_t i = 0; i <= mask_; ++i) {
+            Shard& shard = shards_[i];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            result += ExactRational(unpack(shard.packed.load(std::memory_order_relaxed)));
+            result += shard.overflow;
+        }
+        return result;
+    }
+};
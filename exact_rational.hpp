@@ -0,0 +1,274 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+
+#include "rational.hpp"
+#include "bigint.hpp"
+
+// Точное рациональное число. Пока значение помещается в 64 бита, оно хранится
+// как обычный Rational; если результат операции переполнился бы, числитель и
+// знаменатель переносятся в BigInt и возвращаются в Rational, как только после
+// сокращения снова помещаются. Память под BigInt берётся из ресурса allocator;
+// как и у BigInt, копия остаётся в ресурсе оригинала, а результат операции
+// получает ресурс левого операнда.
+class ExactRational {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+private:
+    friend class RationalMatrix;
+
+    struct BigFraction {
+        BigInt numerator;
+        BigInt denominator;
+    };
+
+    // Дробь возвращается в тот ресурс, в котором лежит её числитель.
+    struct BigDeleter {
+        void operator()(BigFraction* value) const {
+            allocator_type(value->numerator.get_allocator()).delete_object(value);
+        }
+    };
+
+    using BigPtr = std::unique_ptr<BigFraction, BigDeleter>;
+
+    Rational small_;
+    BigPtr big_;
+    allocator_type allocator_;
+
+    static BigPtr make_big(allocator_type allocator, BigInt num, BigInt den) {
+        return BigPtr(allocator.new_object<BigFraction>(
+            BigFraction{BigInt(std::move(num), allocator), BigInt(std::move(den), allocator)}));
+    }
+
+    BigPtr clone_big(const ExactRational& other) const {
+        if (!other.big_) return nullptr;
+        return make_big(allocator_, other.big_->numerator, other.big_->denominator);
+    }
+
+    static bool fits_inline(const Rational& value) {
+        return value.numerator_ != std::numeric_limits<int64_t>::min() &&
+               value.denominator_ <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+    }
+
+    BigFraction as_big() const {
+        if (big_) return *big_;
+        return {BigInt(small_.numerator_, allocator_), BigInt::from_unsigned(small_.denominator_, allocator_)};
+    }
+
+    // Результат и его BigFraction размещаются в ресурсе allocator, а не в
+    // ресурсе промежуточных num и den.
+    static ExactRational from_big(BigInt num, BigInt den, const allocator_type& allocator) {
+        ExactRational result(allocator);
+        if (num.is_zero() || den.is_zero()) return result;
+
+        if (den.is_negative()) {
+            num = -num;
+            den = -den;
+        }
+        BigInt gcd_val = BigInt::gcd(num, den);
+        if (gcd_val != BigInt(1)) {
+            num = num / gcd_val;
+            den = den / gcd_val;
+        }
+
+        int64_t small_num, small_den;
+        if (num.to_int64(small_num) && den.to_int64(small_den) &&
+            small_num != std::numeric_limits<int64_t>::min()) {
+            result.small_.numerator_ = small_num;
+            result.small_.denominator_ = static_cast<uint64_t>(small_den);
+            return result;
+        }
+
+        result.big_ = make_big(result.allocator_, std::move(num), std::move(den));
+        return result;
+    }
+
+    ExactRational reciprocal() const {
+        if (big_) {
+            BigFraction value = *big_;
+            return from_big(std::move(value.denominator), std::move(value.numerator), allocator_);
+        }
+
+        ExactRational result(allocator_);
+        int64_t den = static_cast<int64_t>(small_.denominator_);
+        result.small_.numerator_ = small_.numerator_ < 0 ? -den : den;
+        result.small_.denominator_ = Rational::abs_value(small_.numerator_);
+        return result;
+    }
+
+public:
+    ExactRational() {}
+
+    explicit ExactRational(const allocator_type& allocator) : allocator_(allocator) {}
+
+    ExactRational(int64_t n) : ExactRational(Rational(n)) {}
+
+    ExactRational(int64_t num, int64_t denom) {
+        if (num == std::numeric_limits<int64_t>::min() || denom == std::numeric_limits<int64_t>::min()) {
+            *this = from_big(BigInt(num), BigInt(denom), allocator_);
+        } else {
+            small_ = Rational(num, denom);
+        }
+    }
+
+    ExactRational(const Rational& value, const allocator_type& allocator = {}) : allocator_(allocator) {
+        if (fits_inline(value)) {
+            small_ = value;
+        } else {
+            small_ = Rational();
+            big_ = make_big(allocator_, BigInt(value.numerator_),
+                            BigInt::from_unsigned(value.denominator_));
+        }
+    }
+
+    ExactRational(const ExactRational& other) : ExactRational(other, other.allocator_) {}
+
+    ExactRational(const ExactRational& other, const allocator_type& allocator)
+        : small_(other.small_), allocator_(allocator) {
+        big_ = clone_big(other);
+    }
+
+    // Присваивание оставляет значение в прежнем ресурсе.
+    ExactRational& operator=(const ExactRational& other) {
+        if (this != &other) {
+            small_ = other.small_;
+            big_ = clone_big(other);
+        }
+        return *this;
+    }
+
+    ExactRational(ExactRational&& other) = default;
+
+    ExactRational& operator=(ExactRational&& other) {
+        if (allocator_ != other.allocator_) return *this = other;
+        small_ = other.small_;
+        big_ = std::move(other.big_);
+        return *this;
+    }
+
+    allocator_type get_allocator() const { return allocator_; }
+
+    // true, если значение хранится как Rational без выделения памяти.
+    bool is_inline() const { return !big_; }
+
+    // Записывает значение в out, если оно помещается в Rational.
+    bool to_rational(Rational& out) const {
+        if (big_) return false;
+        out = small_;
+        return true;
+    }
+
+    explicit operator double() const {
+        if (!big_) return static_cast<double>(small_);
+
+        int64_t num_exp, den_exp;
+        double num = big_->numerator.to_double_scaled(num_exp);
+        double den = big_->denominator.to_double_scaled(den_exp);
+        return std::ldexp(num / den, static_cast<int>(num_exp - den_exp));
+    }
+
+    std::string str() const {
+        if (!big_) return small_.str();
+        if (big_->denominator == BigInt(1)) return big_->numerator.str();
+        return big_->numerator.str() + "/" + big_->denominator.str();
+    }
+
+    ExactRational operator-() const {
+        if (big_) {
+            BigFraction value = *big_;
+            return from_big(-value.numerator, std::move(value.denominator), allocator_);
+        }
+
+        ExactRational result(allocator_);
+        result.small_.numerator_ = -small_.numerator_;
+        result.small_.denominator_ = small_.denominator_;
+        return result;
+    }
+
+    ExactRational operator+(const ExactRational& other) const {
+        if (!big_ && !other.big_) {
+            ExactRational result(allocator_);
+            if (Rational::try_add(small_, other.small_, result.small_)) return result;
+        }
+
+        BigFraction a = as_big(), b = other.as_big();
+        return from_big(a.numerator * b.denominator + b.numerator * a.denominator,
+                        a.denominator * b.denominator, allocator_);
+    }
+
+    ExactRational& operator+=(const ExactRational& other) {
+        *this = *this + other;
+        return *this;
+    }
+
+    ExactRational operator-(const ExactRational& other) const {
+        return *this + (-other);
+    }
+
+    ExactRational& operator-=(const ExactRational& other) {
+        *this = *this - other;
+        return *this;
+    }
+
+    ExactRational operator*(const ExactRational& other) const {
+        if (!big_ && !other.big_) {
+            ExactRational result(allocator_);
+            if (Rational::try_mul(small_, other.small_, result.small_)) return result;
+        }
+
+        BigFraction a = as_big(), b = other.as_big();
+        return from_big(a.numerator * b.numerator, a.denominator * b.denominator, allocator_);
+    }
+
+    ExactRational& operator*=(const ExactRational& other) {
+        *this = *this * other;
+        return *this;
+    }
+
+    ExactRational operator/(const ExactRational& other) const {
+        if (!other.big_ && other.small_.numerator_ == 0) {
+            return ExactRational(allocator_);
+        }
+        return *this * other.reciprocal();
+    }
+
+    ExactRational& operator/=(const ExactRational& other) {
+        *this = *this / other;
+        return *this;
+    }
+
+    bool operator==(const ExactRational& other) const {
+        if (!big_ && !other.big_) return small_ == other.small_;
+        if (!big_ || !other.big_) return false;
+        return big_->numerator == other.big_->numerator && big_->denominator == other.big_->denominator;
+    }
+
+    bool operator!=(const ExactRational& other) const {
+        return !(*this == other);
+    }
+
+    bool operator<(const ExactRational& other) const {
+        if (!big_ && !other.big_) return small_ < other.small_;
+
+        BigFraction a = as_big(), b = other.as_big();
+        return a.numerator * b.denominator < b.numerator * a.denominator;
+    }
+
+    bool operator<=(const ExactRational& other) const {
+        return !(other < *this);
+    }
+
+    bool operator>(const ExactRational& other) const {
+        return other < *this;
+    }
+
+    bool operator>=(const ExactRational& other) const {
+        return !(*this < other);
+    }
+};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "rational.hpp"
+
+// Дробь с фиксированным знаменателем Den, известным на этапе компиляции:
+// хранится только числитель, сложение и сравнение — обычные целочисленные
+// операции без сокращения. Значение, не представимое точно (при переходе от
+// Rational или от другого Den), округляется до ближайшего, половина — от нуля.
+// Если числитель результата не помещается в int64_t, он усекается по модулю
+// 2^64, как результаты операторов Rational; from_rational сообщает об этом.
+template <int64_t Den>
+class FixedRational {
+private:
+    static_assert(Den > 0, "знаменатель FixedRational должен быть положительным");
+
+    int64_t numerator_;
+
+    // Младшие 64 бита; false, если значение в int64_t не помещается.
+    static constexpr bool narrow(bool negative, uint128_t mag, int64_t& out) {
+        uint64_t low = static_cast<uint64_t>(mag);
+        out = static_cast<int64_t>(negative ? 0 - low : low);
+        return mag <= static_cast<uint128_t>(INT64_MAX) + (negative ? 1 : 0);
+    }
+
+    static constexpr bool rescale(int128_t num, uint128_t den, int64_t& out) {
+        uint128_t abs_num = num < 0 ? 0 - static_cast<uint128_t>(num) : static_cast<uint128_t>(num);
+        return narrow(num < 0, (abs_num + den / 2) / den, out);
+    }
+
+    static constexpr int64_t rescale_counted(int128_t num, uint128_t den) {
+        int64_t result = 0;
+        if (!rescale(num, den, result)) RATIONAL_COUNT(overflow);
+        return result;
+    }
+
+    template <int64_t OtherDen>
+    static constexpr int64_t from_other(int64_t numerator) {
+        if constexpr (Den % OtherDen == 0) {
+            return mul(numerator, Den / OtherDen);
+        } else {
+            return rescale_counted(static_cast<int128_t>(numerator) * Den, OtherDen);
+        }
+    }
+
+    // Целочисленные операции с усечением при переполнении.
+    static constexpr int64_t add(int64_t a, int64_t b) {
+        int64_t result;
+        if (!checked::add(a, b, result)) return result;
+        RATIONAL_COUNT(overflow);
+        return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+    }
+
+    static constexpr int64_t sub(int64_t a, int64_t b) {
+        int64_t result;
+        if (!checked::sub(a, b, result)) return result;
+        RATIONAL_COUNT(overflow);
+        return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+    }
+
+    static constexpr int64_t mul(int64_t a, int64_t b) {
+        int64_t result;
+        if (!checked::mul(a, b, result)) return result;
+        RATIONAL_COUNT(overflow);
+        return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+    }
+
+public:
+    constexpr FixedRational() : numerator_(0) {}
+
+    constexpr explicit FixedRational(int64_t n) : numerator_(mul(n, Den)) {}
+
+    constexpr explicit FixedRational(const Rational& value)
+        : numerator_(rescale_counted(static_cast<int128_t>(value.numerator()) * Den, value.denominator())) {}
+
+    template <int64_t OtherDen>
+    constexpr explicit FixedRational(const FixedRational<OtherDen>& other)
+        : numerator_(from_other<OtherDen>(other.numerator())) {}
+
+    // Как конструктор от Rational, но возвращает false, если округлённое
+    // значение не помещается (тогда out усечён).
+    static constexpr bool from_rational(const Rational& value, FixedRational& out) {
+        return rescale(static_cast<int128_t>(value.numerator()) * Den, value.denominator(), out.numerator_);
+    }
+
+    // Дробь numerator / Den.
+    static constexpr FixedRational from_numerator(int64_t numerator) {
+        FixedRational result;
+        result.numerator_ = numerator;
+        return result;
+    }
+
+    constexpr int64_t numerator() const { return numerator_; }
+    static constexpr int64_t denominator() { return Den; }
+
+    explicit constexpr operator Rational() const {
+        return Rational(numerator_, Den);
+    }
+
+    explicit constexpr operator double() const {
+        return static_cast<double>(numerator_) / static_cast<double>(Den);
+    }
+
+    std::string str() const {
+        return static_cast<Rational>(*this).str();
+    }
+
+    constexpr FixedRational operator-() const {
+        return from_numerator(sub(0, numerator_));
+    }
+
+    constexpr FixedRational operator+(const FixedRational& other) const {
+        return from_numerator(add(numerator_, other.numerator_));
+    }
+
+    constexpr FixedRational& operator+=(const FixedRational& other) {
+        numerator_ = add(numerator_, other.numerator_);
+        return *this;
+    }
+
+    constexpr FixedRational operator-(const FixedRational& other) const {
+        return from_numerator(sub(numerator_, other.numerator_));
+    }
+
+    constexpr FixedRational& operator-=(const FixedRational& other) {
+        numerator_ = sub(numerator_, other.numerator_);
+        return *this;
+    }
+
+    constexpr FixedRational operator*(int64_t k) const {
+        return from_numerator(mul(numerator_, k));
+    }
+
+    constexpr FixedRational& operator*=(int64_t k) {
+        numerator_ = mul(numerator_, k);
+        return *this;
+    }
+
+    constexpr bool operator==(const FixedRational& other) const {
+        return numerator_ == other.numerator_;
+    }
+
+    constexpr bool operator!=(const FixedRational& other) const {
+        return numerator_ != other.numerator_;
+    }
+
+    constexpr bool operator<(const FixedRational& other) const {
+        return numerator_ < other.numerator_;
+    }
+
+    constexpr bool operator<=(const FixedRational& other) const {
+        return numerator_ <= other.numerator_;
+    }
+
+    constexpr bool operator>(const FixedRational& other) const {
+        return numerator_ > other.numerator_;
+    }
+
+    constexpr bool operator>=(const FixedRational& other) const {
+        return numerator_ >= other.numerator_;
+    }
+};
@@ -0,0 +1,734 @@
+// Дифференциальная проверка быстрых путей: операнды (случайные и граничные)
+// прогоняются через Rational, PackedRational, RationalAccumulator, RationalSoA,
+// Rational::sum, FixedRational, ConcurrentRationalSum, ленивые выражения,
+// ExactRational, текстовый и двоичный форматы, преобразования в double и из
+// него, округление и цепные дроби, а результаты сравниваются с медленным
+// эталоном на BigInt. Если точный результат не помещается в Rational,
+// проверяется только отсутствие неопределённого поведения (для этого цель
+// собирается с санитайзерами). Сам BigInt сверяется с __int128 и с заранее
+// посчитанными значениями, чтобы его ошибка не прошла незамеченной через эталон
+// и ExactRational сразу.
+//
+// С RATIONAL_FUZZ_LIBFUZZER это цель libFuzzer; иначе — самостоятельная
+// программа: rational_fuzz [--iterations N] [--seed S].
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rational.hpp"
+#include "bigint.hpp"
+#include "exact_rational.hpp"
+#include "packed_rational.hpp"
+#include "rational_accumulator.hpp"
+#include "rational_soa.hpp"
+#include "rational_expr.hpp"
+#include "rational_binary.hpp"
+#include "concurrent_rational_sum.hpp"
+#include "fixed_rational.hpp"
+
+namespace {
+
+constexpr int64_t min64 = std::numeric_limits<int64_t>::min();
+constexpr int64_t max64 = std::numeric_limits<int64_t>::max();
+
+// Эталонная дробь: числитель и знаменатель произвольной длины, сокращение
+// алгоритмом Евклида. Деление на ноль, как и у Rational, даёт 0.
+struct Reference {
+    BigInt num;
+    BigInt den;
+
+    static Reference make(BigInt num, BigInt den) {
+        if (den.is_zero() || num.is_zero()) return {BigInt(0), BigInt(1)};
+        if (den.is_negative()) {
+            num = -num;
+            den = -den;
+        }
+        BigInt gcd_val = BigInt::gcd(num, den);
+        return {num / gcd_val, den / gcd_val};
+    }
+
+    static Reference of(const Rational& value) {
+        return {BigInt(value.numerator()), BigInt::from_unsigned(value.denominator())};
+    }
+
+    Reference operator+(const Reference& other) const { return make(num * other.den + other.num * den, den * other.den); }
+    Reference operator-(const Reference& other) const { return make(num * other.den - other.num * den, den * other.den); }
+    Reference operator*(const Reference& other) const { return make(num * other.num, den * other.den); }
+    Reference operator/(const Reference& other) const { return make(num * other.den, den * other.num); }
+
+    int compare(const Reference& other) const {
+        BigInt lhs = num * other.den, rhs = other.num * den;
+        return (rhs < lhs) - (lhs < rhs);
+    }
+
+    // Результат операции Rational точен, только если он и противоположный ему
+    // помещаются в 64 бита.
+    bool fits() const {
+        int64_t n, d;
+        return num.to_int64(n) && n != min64 && den.to_int64(d);
+    }
+
+    bool equals(const Rational& value) const {
+        return num == BigInt(value.numerator()) && den == BigInt::from_unsigned(value.denominator());
+    }
+
+    std::string str() const { return den == BigInt(1) ? num.str() : num.str() + "/" + den.str(); }
+};
+
+std::string wide_str(int128_t value) {
+    uint128_t mag = value < 0 ? 0 - static_cast<uint128_t>(value) : static_cast<uint128_t>(value);
+    std::string digits;
+    do {
+        digits.insert(digits.begin(), static_cast<char>('0' + static_cast<int>(mag % 10)));
+        mag /= 10;
+    } while (mag != 0);
+    return value < 0 ? "-" + digits : digits;
+}
+
+uint128_t wide_gcd(uint128_t a, uint128_t b) {
+    while (b != 0) {
+        uint128_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+BigInt power_of_two(int exponent) {
+    BigInt result(1);
+    for (; exponent >= 32; exponent -= 32) result = result * BigInt::from_unsigned(uint64_t(1) << 32);
+    return result * BigInt::from_unsigned(uint64_t(1) << exponent);
+}
+
+// Младшие 64 бита x в дополнительном коде, через деление на степени двойки.
+uint64_t low_64(const BigInt& x) {
+    BigInt two32 = power_of_two(32), rest = x.abs() % power_of_two(64);
+    int64_t high = 0, low = 0;
+    (rest / two32).to_int64(high);
+    (rest % two32).to_int64(low);
+    uint64_t mag = static_cast<uint64_t>(high) << 32 | static_cast<uint64_t>(low);
+    return x.is_negative() ? 0 - mag : mag;
+}
+
+// Точное значение конечного double.
+Reference of_double(double value) {
+    int exponent;
+    double fraction = std::frexp(value, &exponent);
+    BigInt mantissa(static_cast<int64_t>(std::ldexp(fraction, 53)));
+    exponent -= 53;
+    if (exponent >= 0) return Reference::make(mantissa * power_of_two(exponent), BigInt(1));
+    return Reference::make(mantissa, power_of_two(-exponent));
+}
+
+// Читает операнды из входных байт; после их конца возвращает нули.
+class Input {
+private:
+    const uint8_t* data_;
+    size_t size_;
+
+public:
+    Input(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    bool empty() const { return size_ == 0; }
+
+    uint8_t byte() {
+        if (size_ == 0) return 0;
+        --size_;
+        return *data_++;
+    }
+
+    uint64_t word() {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value = (value << 8) | byte();
+        return value;
+    }
+
+    // Случайное или граничное целое: крайние значения, окрестности 2^31, 2^32,
+    // 2^53 и 2^63, большие простые, малые числа и полные 64 бита.
+    int64_t integer() {
+        static constexpr int64_t edges[] = {
+            0, 1, -1, 2, -2, min64, min64 + 1, max64, max64 - 1,
+            (int64_t(1) << 31) - 1, int64_t(1) << 31, -(int64_t(1) << 31), (int64_t(1) << 32) - 1,
+            int64_t(1) << 32, (int64_t(1) << 53) + 1, int64_t(1) << 62, -(int64_t(1) << 62),
+            3037000499, 3037000500, 4294967291, 2147483647, 9223372036854775783, -9223372036854775783,
+            6700417, 9007199254740881, 1000000007, 998244353,
+        };
+        uint8_t mode = byte();
+        uint64_t raw = word();
+        switch (mode % 8) {
+        case 0:
+        case 1:
+            return edges[raw % (sizeof(edges) / sizeof(edges[0]))];
+        case 2:
+            return static_cast<int64_t>(raw % 2001) - 1000;
+        case 3:
+            return static_cast<int64_t>(raw >> 32) - (int64_t(1) << 31);
+        case 4: {
+            // Рядом с границей переполнения.
+            int64_t near = max64 - static_cast<int64_t>(raw % 1024);
+            return raw & (1u << 20) ? -near : near;
+        }
+        case 5:
+            return static_cast<int64_t>(uint64_t(1) << (raw % 63)) * ((raw >> 8) & 1 ? -1 : 1);
+        default:
+            return static_cast<int64_t>(raw);
+        }
+    }
+
+    // Дробь из области определения конструктора: знаменатель INT64_MIN и
+    // отрицательный знаменатель при числителе INT64_MIN не поддерживаются.
+    void fraction(int64_t& num, int64_t& den) {
+        num = integer();
+        den = integer();
+        if (den == min64) den = max64;
+        if (den < 0 && num == min64) den = -den;
+    }
+};
+
+[[noreturn]] void fail(const char* what, const std::string& operands, const std::string& got, const std::string& expected) {
+    std::fprintf(stderr, "rational_fuzz: %s\n  операнды: %s\n  получено: %s\n  ожидалось: %s\n", what,
+                 operands.c_str(), got.c_str(), expected.c_str());
+    std::abort();
+}
+
+std::string describe(const Rational& a, const Rational& b) {
+    return a.str() + ", " + b.str();
+}
+
+// Точный результат должен совпасть с эталоном; непредставимый не проверяется.
+void expect(const char* what, const std::string& operands, const Rational& got, const Reference& expected) {
+    if (expected.fits() && !expected.equals(got)) fail(what, operands, got.str(), expected.str());
+}
+
+void check_construction(int64_t num, int64_t den) {
+    Rational value(num, den);
+    Reference expected = Reference::make(BigInt(num), BigInt(den));
+    std::string operands = std::to_string(num) + ", " + std::to_string(den);
+    if (!expected.equals(value)) fail("Rational(n, d)", operands, value.str(), expected.str());
+    Rational cached = Rational::cached(num, den);
+    if (cached != value) fail("Rational::cached", operands, cached.str(), value.str());
+}
+
+void check_arithmetic(const Rational& a, const Rational& b, int64_t k) {
+    Reference ra = Reference::of(a), rb = Reference::of(b), rk = Reference::of(Rational(k));
+    std::string ops = describe(a, b);
+
+    expect("a + b", ops, a + b, ra + rb);
+    expect("a - b", ops, a - b, ra - rb);
+    expect("a * b", ops, a * b, ra * rb);
+    expect("a / b", ops, a / b, ra / rb);
+
+    Rational c = a;
+    expect("a += b", ops, c += b, ra + rb);
+    c = a;
+    expect("a -= b", ops, c -= b, ra - rb);
+    c = a;
+    expect("a *= b", ops, c *= b, ra * rb);
+    c = a;
+    expect("a /= b", ops, c /= b, ra / rb);
+
+    RationalAccumulator acc(a);
+    expect("accumulator += b", ops, (acc += b).value(), ra + rb);
+    acc = RationalAccumulator(a);
+    expect("accumulator -= b", ops, (acc -= b).value(), ra - rb);
+    acc = RationalAccumulator(a);
+    expect("accumulator *= b", ops, (acc *= b).value(), ra * rb);
+
+    std::string with_k = a.str() + ", " + std::to_string(k);
+    expect("a + k", with_k, a + k, ra + rk);
+    expect("a - k", with_k, a - k, ra - rk);
+    expect("a * k", with_k, a * k, ra * rk);
+    expect("a / k", with_k, a / k, ra / rk);
+    expect("k - a", with_k, k - a, rk - ra);
+    expect("k / a", with_k, k / a, rk / ra);
+
+    int expected = ra.compare(rb);
+    int got = (a < b) ? -1 : (b < a) ? 1 : 0;
+    if (got != expected || (a == b) != (expected == 0) || ((a <=> b) < 0) != (expected < 0)) {
+        fail("сравнение", ops, std::to_string(got), std::to_string(expected));
+    }
+    int expected_k = ra.compare(rk);
+    if (((a <=> k) < 0) != (expected_k < 0) || ((a <=> k) > 0) != (expected_k > 0) || (a == k) != (expected_k == 0)) {
+        fail("сравнение с целым", with_k, std::to_string((a <=> k) < 0), std::to_string(expected_k));
+    }
+
+    // Правильно округлённое преобразование монотонно.
+    if (expected < 0 && a.to_double() > b.to_double()) fail("to_double", ops, "a > b", "a <= b");
+}
+
+Reference distance(const Reference& a, const Reference& b) {
+    Reference d = a - b;
+    if (d.num.is_negative()) d.num = -d.num;
+    return d;
+}
+
+// Числитель x * Den, округлённый до ближайшего целого, половина — от нуля.
+BigInt fixed_numerator(const Reference& x, int64_t den) {
+    BigInt scaled = x.num.abs() * BigInt(den) * BigInt(2) + x.den;
+    BigInt rounded = scaled / (x.den * BigInt(2));
+    return x.num.is_negative() ? -rounded : rounded;
+}
+
+// to_double даёт ближайший double, при равенстве — с чётной мантиссой.
+void check_to_double(const Rational& a) {
+    double got = a.to_double();
+    if (a == Rational()) {
+        if (got != 0) fail("to_double", a.str(), std::to_string(got), "0");
+        return;
+    }
+
+    Reference ra = Reference::of(a), error = distance(of_double(got), ra);
+    bool even = (std::bit_cast<uint64_t>(got) & 1) == 0;
+    for (double neighbour : {std::nextafter(got, -INFINITY), std::nextafter(got, INFINITY)}) {
+        int order = error.compare(distance(of_double(neighbour), ra));
+        if (order > 0 || (order == 0 && !even)) {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%a", got);
+            fail("to_double", a.str(), text, "ближайший double");
+        }
+    }
+}
+
+// Ни одна дробь k / den с допустимым знаменателем den не ближе к value, чем
+// from_double; представимое точно значение восстанавливается точно.
+void check_from_double(double value, uint64_t max_den) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "%a, %llu", value, static_cast<unsigned long long>(max_den));
+    Rational out(7);
+    bool ok = Rational::from_double(value, max_den, out);
+    if (!std::isfinite(value) || std::fabs(value) >= 0x1p63) {
+        if (ok || out != Rational(7)) fail("from_double вне диапазона", text, out.str(), "false");
+        return;
+    }
+    if (!ok) fail("from_double", text, "false", "true");
+
+    // Как и from_double, знаменатель ограничен так, чтобы числитель помещался в int64_t.
+    uint64_t den = std::min(std::clamp<uint64_t>(max_den, 1, max64), static_cast<uint64_t>(max64) / (static_cast<uint64_t>(std::fabs(value)) + 1));
+    Reference exact = of_double(value);
+    Reference nearest = Reference::make(fixed_numerator(exact, static_cast<int64_t>(den)), BigInt(static_cast<int64_t>(den)));
+    if (out.denominator() > den || distance(Reference::of(out), exact).compare(distance(nearest, exact)) > 0) {
+        fail("from_double", text, out.str(), nearest.str());
+    }
+    int64_t exact_den;
+    if (exact.den.to_int64(exact_den) && static_cast<uint64_t>(exact_den) <= den && !exact.equals(out)) {
+        fail("from_double точного значения", text, out.str(), exact.str());
+    }
+}
+
+// BigInt в пределах 128 бит сверяется с __int128: x = a * b и y = c * d.
+void check_bigint(int64_t a, int64_t b, int64_t c, int64_t d) {
+    BigInt x = BigInt(a) * BigInt(b), y = BigInt(c) * BigInt(d);
+    int128_t wx = static_cast<int128_t>(a) * b, wy = static_cast<int128_t>(c) * d;
+    std::string ops = wide_str(wx) + ", " + wide_str(wy);
+    auto same = [&](const char* what, const BigInt& got, int128_t expected) {
+        if (got.str() != wide_str(expected)) fail(what, ops, got.str(), wide_str(expected));
+    };
+
+    if (BigInt(a).str() != std::to_string(a)) fail("BigInt(a).str()", ops, BigInt(a).str(), std::to_string(a));
+    int64_t narrowed;
+    if (!BigInt(a).to_int64(narrowed) || narrowed != a) fail("BigInt::to_int64", ops, std::to_string(narrowed), std::to_string(a));
+    if (x.to_int64(narrowed) != (wx >= min64 && wx <= max64)) fail("BigInt::to_int64 вне диапазона", ops, x.str(), "");
+
+    same("BigInt a * b", x, wx);
+    same("BigInt x + y", x + y, wx + wy);
+    same("BigInt x - y", x - y, wx - wy);
+    same("BigInt -x", -x, -wx);
+    if ((x < y) != (wx < wy) || (x == y) != (wx == wy) || (x <= y) != (wx <= wy)) {
+        fail("BigInt сравнение", ops, std::to_string(x < y), std::to_string(wx < wy));
+    }
+    if (wy != 0) {
+        same("BigInt x / y", x / y, wx / wy);
+        same("BigInt x % y", x % y, wx % wy);
+        uint128_t ux = wx < 0 ? 0 - static_cast<uint128_t>(wx) : static_cast<uint128_t>(wx);
+        uint128_t uy = wy < 0 ? 0 - static_cast<uint128_t>(wy) : static_cast<uint128_t>(wy);
+        same("BigInt::gcd", BigInt::gcd(x, y), static_cast<int128_t>(wide_gcd(ux, uy)));
+
+        // Больше 128 бит: деление обратно умножению, остаток меньше делителя.
+        BigInt r = (x % y).abs(), z = x * y, m = x.abs() * y.abs();
+        if (z / y != x || z % y != BigInt(0) || (m + r) / y.abs() != x.abs() || (m + r) % y.abs() != r) {
+            fail("BigInt деление x * y", ops, (z / y).str(), x.str());
+        }
+    }
+}
+
+// Заранее посчитанные значения для чисел длиннее 128 бит.
+void check_bigint_known() {
+    auto expect_str = [](const char* what, const BigInt& got, const char* expected) {
+        if (got.str() != expected) fail(what, "", got.str(), expected);
+    };
+    expect_str("2^200", power_of_two(200), "1606938044258990275541962092341162602522202993782792835301376");
+
+    BigInt factorial(1);
+    for (int i = 2; i <= 50; ++i) factorial = factorial * BigInt(i);
+    expect_str("50!", factorial, "30414093201713378043612608166064768844377641568960512000000000000");
+
+    // НОД(F(300), F(200)) = F(НОД(300, 200)) = F(100).
+    std::vector<BigInt> fib = {BigInt(0), BigInt(1)};
+    while (fib.size() <= 300) fib.push_back(fib[fib.size() - 1] + fib[fib.size() - 2]);
+    expect_str("F(100)", fib[100], "354224848179261915075");
+    expect_str("НОД(F(300), F(200))", BigInt::gcd(fib[300], fib[200]), "354224848179261915075");
+
+    BigInt ten40(1);
+    for (int i = 0; i < 40; ++i) ten40 = ten40 * BigInt(10);
+    expect_str("10^40 / 7", ten40 / BigInt(7), "1428571428571428571428571428571428571428");
+    expect_str("10^40 % 7", ten40 % BigInt(7), "4");
+    expect_str("(2^127 - 1)(2^89 - 1)", (power_of_two(127) - BigInt(1)) * (power_of_two(89) - BigInt(1)),
+               "105312291668557186697918027513529248857806893649219117400977309697");
+
+    BigInt three200(1);
+    for (int i = 0; i < 200; ++i) three200 = three200 * BigInt(3);
+    BigInt divisor = power_of_two(100) + BigInt(277);
+    expect_str("3^200 / (2^100 + 277)", three200 / divisor,
+               "209532491703986330431325155536880254117884003623234037796386629922");
+    expect_str("3^200 % (2^100 + 277)", three200 % divisor, "540343785267243089937929694935");
+    expect_str("-3^200 / (2^100 + 277)", -three200 / divisor,
+               "-209532491703986330431325155536880254117884003623234037796386629922");
+}
+
+void check_packed(const Rational& a, const Rational& b) {
+    PackedRational pa(a), pb(b);
+    Reference ra = Reference::of(a), rb = Reference::of(b);
+    std::string ops = describe(a, b);
+
+    if (pa.value() != a) fail("PackedRational(a)", ops, pa.str(), a.str());
+    expect("packed a + b", ops, (pa + pb).value(), ra + rb);
+    expect("packed a - b", ops, (pa - pb).value(), ra - rb);
+    expect("packed a * b", ops, (pa * pb).value(), ra * rb);
+    expect("packed a / b", ops, (pa / pb).value(), ra / rb);
+    if ((pa < pb) != (ra.compare(rb) < 0) || (pa == pb) != (a == b)) {
+        fail("packed сравнение", ops, std::to_string(pa < pb), std::to_string(ra.compare(rb)));
+    }
+}
+
+// Если НОК знаменателей и сумма |n_i| * (НОК / d_i) помещаются в int64_t,
+// любая частичная сумма в любом порядке точна, и отложенное сокращение обязано
+// дать тот же результат, что и эталон.
+bool partial_sums_fit(const std::vector<Rational>& terms) {
+    BigInt lcm(1), bound(0);
+    for (const Rational& term : terms) {
+        BigInt den = BigInt::from_unsigned(term.denominator());
+        lcm = lcm / BigInt::gcd(lcm, den) * den;
+    }
+    for (const Rational& term : terms) {
+        bound = bound + BigInt(term.numerator()).abs() * (lcm / BigInt::from_unsigned(term.denominator()));
+    }
+    int64_t value;
+    return lcm.to_int64(value) && bound.to_int64(value);
+}
+
+void check_sums(const std::vector<Rational>& terms) {
+    Reference expected = Reference::of(Rational()), alternating = expected;
+    RationalAccumulator acc, alternating_acc;
+    ExactRational exact;
+    std::string ops;
+    for (size_t i = 0; i < terms.size(); ++i) {
+        const Rational& term = terms[i];
+        expected = expected + Reference::of(term);
+        acc += term;
+        exact += ExactRational(term);
+        ops += term.str() + " ";
+        // Нечётные слагаемые вычитаются.
+        if (i % 2) {
+            alternating = alternating - Reference::of(term);
+            alternating_acc -= term;
+        } else {
+            alternating = alternating + Reference::of(term);
+            alternating_acc += term;
+        }
+    }
+
+    if (exact.str() != expected.str()) fail("ExactRational сумма", ops, exact.str(), expected.str());
+    // Rational::sum точна всегда, когда помещается сам результат; иначе от
+    // сокращённой точной суммы остаются младшие 64 бита, как у from_wide.
+    Rational sum = Rational::sum(terms.begin(), terms.end());
+    expect("Rational::sum", ops, sum, expected);
+    if (!expected.fits() && (static_cast<uint64_t>(sum.numerator()) != low_64(expected.num) ||
+                             sum.denominator() != low_64(expected.den))) {
+        fail("Rational::sum с усечением", ops, sum.str(), expected.str());
+    }
+    if (!partial_sums_fit(terms)) return;
+    expect("RationalAccumulator", ops, acc.value(), expected);
+    expect("RationalAccumulator +=/-=", ops, alternating_acc.value(), alternating);
+}
+
+// Сумма точна при любом порядке; у одного шарда слово переносится в overflow
+// при каждом приближении к границе упакованной формы. В потоках слагаемые
+// добавляются repeats раз, чтобы обновления одного слова пересекались.
+void check_concurrent_sum(const std::vector<Rational>& terms, int repeats = 0) {
+    Reference expected = Reference::of(Rational());
+    ConcurrentRationalSum single(1), shared;
+    std::string ops;
+    for (size_t i = 0; i < terms.size(); ++i) {
+        ops += terms[i].str() + " ";
+        if (i % 2) {
+            expected = expected - Reference::of(terms[i]);
+            single -= terms[i];
+        } else {
+            expected = expected + Reference::of(terms[i]);
+            single += terms[i];
+        }
+    }
+    if (single.total().str() != expected.str()) fail("ConcurrentRationalSum", ops, single.total().str(), expected.str());
+    if (repeats == 0) return;
+
+    constexpr int threads = 4;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (int r = 0; r < repeats; ++r) {
+                for (size_t i = 0; i < terms.size(); ++i) {
+                    if (i % 2) shared -= terms[i];
+                    else shared += terms[i];
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    Reference all = expected * Reference::of(Rational(threads * repeats));
+    if (shared.total().str() != all.str()) fail("ConcurrentRationalSum в потоках", ops, shared.total().str(), all.str());
+}
+
+void check_exact(const Rational& a, const Rational& b) {
+    Reference ra = Reference::of(a), rb = Reference::of(b);
+    ExactRational ea(a), eb(b);
+    std::string ops = describe(a, b);
+    if ((ea * eb).str() != (ra * rb).str()) fail("ExactRational a * b", ops, (ea * eb).str(), (ra * rb).str());
+    if ((ea / eb).str() != (ra / rb).str()) fail("ExactRational a / b", ops, (ea / eb).str(), (ra / rb).str());
+    if ((ea - eb).str() != (ra - rb).str()) fail("ExactRational a - b", ops, (ea - eb).str(), (ra - rb).str());
+    if ((ea < eb) != (ra.compare(rb) < 0)) fail("ExactRational a < b", ops, std::to_string(ea < eb), "");
+}
+
+void check_batches(const std::vector<Rational>& a, const std::vector<Rational>& b) {
+    RationalSoA sa, sb;
+    for (size_t i = 0; i < a.size(); ++i) {
+        sa.push_back(a[i]);
+        sb.push_back(b[i]);
+    }
+    RationalSoA sum(a.size()), product(a.size());
+    std::vector<int8_t> order(a.size());
+    RationalSoA::add(sa, sb, sum);
+    RationalSoA::mul(sa, sb, product);
+    RationalSoA::compare(sa, sb, order);
+
+    for (size_t i = 0; i < a.size(); ++i) {
+        Reference ra = Reference::of(a[i]), rb = Reference::of(b[i]);
+        std::string ops = describe(a[i], b[i]);
+        expect("RationalSoA::add", ops, sum[i], ra + rb);
+        expect("RationalSoA::mul", ops, product[i], ra * rb);
+        if (order[i] != ra.compare(rb)) fail("RationalSoA::compare", ops, std::to_string(order[i]), std::to_string(ra.compare(rb)));
+    }
+}
+
+// Целочисленный результат FixedRational точен, если помещается в int64_t.
+template <int64_t Den>
+void expect_fixed(const char* what, const std::string& operands, const FixedRational<Den>& got, const BigInt& expected) {
+    int64_t value;
+    if (expected.to_int64(value) && value != got.numerator()) {
+        fail(what, operands, std::to_string(got.numerator()), expected.str());
+    }
+}
+
+template <int64_t Den, int64_t OtherDen>
+void check_fixed(const Rational& a, const Rational& b, int64_t k) {
+    Reference ra = Reference::of(a), rb = Reference::of(b);
+    std::string ops = describe(a, b) + ", " + std::to_string(k) + ", Den " + std::to_string(Den);
+
+    FixedRational<Den> fa(a), fb(b), checked;
+    BigInt na = fixed_numerator(ra, Den), nb = fixed_numerator(rb, Den);
+    int64_t value;
+    if (FixedRational<Den>::from_rational(a, checked) != na.to_int64(value) || checked != fa) {
+        fail("FixedRational::from_rational", ops, std::to_string(checked.numerator()), na.str());
+    }
+    expect_fixed("FixedRational(Rational)", ops, fa, na);
+    if (!na.to_int64(value) || !nb.to_int64(value)) return;
+
+    expect_fixed("FixedRational(k)", ops, FixedRational<Den>(k), BigInt(k) * BigInt(Den));
+    expect_fixed("FixedRational a + b", ops, fa + fb, na + nb);
+    expect_fixed("FixedRational a - b", ops, fa - fb, na - nb);
+    expect_fixed("FixedRational -a", ops, -fa, -na);
+    expect_fixed("FixedRational a * k", ops, fa * k, na * BigInt(k));
+    FixedRational<Den> c = fa;
+    expect_fixed("FixedRational a += b", ops, c += fb, na + nb);
+    c = fa;
+    expect_fixed("FixedRational a -= b", ops, c -= fb, na - nb);
+    c = fa;
+    expect_fixed("FixedRational a *= k", ops, c *= k, na * BigInt(k));
+    if ((fa < fb) != (na < nb) || (fa == fb) != (na == nb)) fail("FixedRational сравнение", ops, "", "");
+    Reference exact = Reference::make(na, BigInt(Den));
+    if (!exact.equals(static_cast<Rational>(fa))) fail("FixedRational -> Rational", ops, fa.str(), exact.str());
+
+    FixedRational<OtherDen> other(fa);
+    expect_fixed("FixedRational<OtherDen>(a)", ops, other, fixed_numerator(exact, OtherDen));
+}
+
+// Ленивое выражение обязано совпадать с пошаговым вычислением.
+void check_fused(const Rational& a, const Rational& b, const Rational& c, const Rational& d) {
+    Rational stepwise = a * b + c / d - a;
+    Rational lazy = fused(a) * b + c / d - a;
+    if (lazy != stepwise) fail("fused", describe(a, b) + ", " + describe(c, d), lazy.str(), stepwise.str());
+}
+
+void check_formats(const Rational& a) {
+    char text[Rational::max_chars];
+    std::to_chars_result written = a.to_chars(text, text + sizeof(text));
+    Rational parsed;
+    std::from_chars_result read = Rational::from_chars(text, written.ptr, parsed);
+    if (written.ec != std::errc() || read.ec != std::errc() || read.ptr != written.ptr || parsed != a) {
+        fail("to_chars/from_chars", a.str(), parsed.str(), a.str());
+    }
+
+    uint8_t bytes[RationalCodec::max_encoded_size];
+    uint8_t* end = RationalCodec::encode(a, bytes);
+    Rational decoded;
+    if (RationalCodec::decode(bytes, end, decoded) != end || decoded != a) {
+        fail("RationalCodec", a.str(), decoded.str(), a.str());
+    }
+}
+
+void check_approximation(const Rational& a, uint64_t max_den) {
+    Reference ra = Reference::of(a);
+    std::string ops = a.str() + ", " + std::to_string(max_den);
+
+    Reference floor = Reference::of(Rational(a.floor())), ceil = Reference::of(Rational(a.ceil()));
+    Reference one = Reference::of(Rational(1)), half = Reference::make(BigInt(1), BigInt(2));
+    if (floor.compare(ra) > 0 || (floor + one).compare(ra) <= 0 || ceil.compare(ra) < 0 ||
+        (ceil - one).compare(ra) >= 0) {
+        fail("floor/ceil", ops, std::to_string(a.floor()) + " " + std::to_string(a.ceil()), "");
+    }
+    if (distance(Reference::of(Rational(a.round())), ra).compare(half) > 0) {
+        fail("round", ops, std::to_string(a.round()), "");
+    }
+
+    // Ни одна дробь k / max_den не ближе к a, чем limit_denominator(max_den).
+    Rational limited = a.limit_denominator(max_den);
+    Reference rounded = Reference::of(a.round_to(max_den));
+    if (limited.denominator() > std::max<uint64_t>(max_den, 1) ||
+        distance(Reference::of(limited), ra).compare(distance(rounded, ra)) > 0) {
+        fail("limit_denominator", ops, limited.str(), a.round_to(max_den).str());
+    }
+
+    ContinuedFraction terms(a);
+    int64_t term;
+    Rational last;
+    for (int count = 0; terms.next(term); ++count) {
+        if (count > 0 && term <= 0) fail("ContinuedFraction", ops, std::to_string(term), "> 0");
+        last = terms.convergent();
+    }
+    if (last != a) fail("ContinuedFraction", ops, last.str(), a.str());
+}
+
+// Случаи, в которых быстрые пути раньше ошибались.
+void check_regressions() {
+    check_bigint_known();
+    // Сумма корзины со знаменателем 3 не помещается в 64 бита, а общая сумма помещается.
+    check_sums({Rational(8816733017949335672, 3), Rational(3135225116083045931, 3), Rational(-2544991238947044356)});
+    // Непомещающаяся сумма усекалась попарными слияниями, а не от точного значения.
+    check_sums({Rational(max64, 3), Rational(max64, 5), Rational(max64, 7)});
+    // -INT64_MIN / 3 в RationalAccumulator::operator-= переполнялся при смене знака.
+    check_arithmetic(Rational(-1, 3), Rational(min64, 3), 1);
+    check_concurrent_sum({Rational(-1, 3), Rational(min64, 3)}, 4);
+    // Усечение при переводе в FixedRational давало 0 без сообщения о переполнении.
+    check_fixed<2, 1>(Rational(min64), Rational(max64), min64);
+    // Упакованное слово шарда несколько раз выходит за 2^31 и переносится в overflow.
+    std::vector<Rational> large;
+    for (int i = 0; i < 16; ++i) large.push_back(Rational(i % 2 ? -(int64_t(1) << 30) : int64_t(1) << 30, 7));
+    check_concurrent_sum(large, 4);
+}
+
+void run_one(Input& in) {
+    std::vector<Rational> values;
+    while (values.size() < 8) {
+        int64_t num, den;
+        in.fraction(num, den);
+        check_construction(num, den);
+        values.push_back(Rational(num, den));
+    }
+    int64_t k = in.integer();
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        const Rational& a = values[i];
+        const Rational& b = values[(i + 1) % values.size()];
+        check_arithmetic(a, b, k);
+        check_packed(a, b);
+        check_exact(a, b);
+        check_formats(a);
+        check_fixed<1000, 48000>(a, b, k);
+        check_fixed<48000, 1000>(a, b, k);
+        check_fixed<1, 3>(a, b, k);
+        check_approximation(a, static_cast<uint64_t>(in.integer()) >> (in.byte() % 64));
+        check_to_double(a);
+        check_from_double(a.to_double(), static_cast<uint64_t>(in.integer()) >> (in.byte() % 64));
+        check_from_double(std::bit_cast<double>(in.word()), static_cast<uint64_t>(in.integer()));
+        check_bigint(a.numerator(), in.integer(), b.numerator(), in.integer());
+    }
+    check_fused(values[0], values[1], values[2], values[3]);
+    check_sums(values);
+    check_sums({values.begin(), values.begin() + 3});
+
+    // Слагаемые с общим знаменателем попадают в одну корзину Rational::sum.
+    std::vector<Rational> shared;
+    for (const Rational& value : values) shared.push_back(Rational(value.numerator(), values[0].denominator()));
+    shared.push_back(Rational(k));
+    check_sums(shared);
+    check_concurrent_sum(values);
+
+    // Малые слагаемые идут через упакованное слово без блокировок.
+    std::vector<Rational> small;
+    for (const Rational& value : values) {
+        small.push_back(Rational(value.numerator() % (int64_t(1) << 28), value.denominator() % 60 + 1));
+    }
+    check_concurrent_sum(small, 64);
+    check_batches({values.begin(), values.begin() + 4}, {values.begin() + 4, values.end()});
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerInitialize(int*, char***) {
+    check_regressions();
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    Input in(data, size);
+    run_one(in);
+    return 0;
+}
+
+#ifndef RATIONAL_FUZZ_LIBFUZZER
+int main(int argc, char** argv) {
+    size_t iterations = 1000;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "использование: rational_fuzz [--iterations N] [--seed S]\n");
+            return 2;
+        }
+    }
+    LLVMFuzzerInitialize(&argc, &argv);
+
+    std::mt19937_64 rng(seed);
+    std::vector<uint8_t> data(8 * 9 * 20);
+    for (size_t i = 0; i < iterations; ++i) {
+        for (uint8_t& byte : data) byte = static_cast<uint8_t>(rng());
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+    }
+    std::printf("rational_fuzz: %zu итераций без расхождений (seed %llu)\n", iterations,
+                static_cast<unsigned long long>(seed));
+    return 0;
+}
+#endif
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <limits>
+
+#include "rational.hpp"
+#include "binary_gcd.hpp"
+
+// Дробь размером 8 байт. Если числитель помещается в int32_t, а знаменатель
+// меньше 2^31, оба хранятся прямо в слове (числитель в старших 32 битах,
+// знаменатель в битах 1..31, младший бит — 0). Иначе младший бит равен 1,
+// а остальные биты — указатель на Rational в куче.
+class PackedRational {
+private:
+    friend class ConcurrentRationalSum;
+
+    static_assert(sizeof(void*) <= sizeof(uint64_t), "указатель должен помещаться в 64 бита");
+    static_assert(alignof(Rational) >= 2, "младший бит указателя используется как признак");
+
+    static constexpr uint64_t escape_tag = 1;
+
+    uint64_t bits_;
+
+    static constexpr bool fits_packed(int64_t num, uint64_t den) {
+        return num >= std::numeric_limits<int32_t>::min() && num <= std::numeric_limits<int32_t>::max() &&
+               den < (uint64_t(1) << 31);
+    }
+
+    static constexpr uint64_t pack(int64_t num, uint64_t den) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(static_cast<int32_t>(num))) << 32) | (den << 1);
+    }
+
+    bool is_escaped() const { return (bits_ & escape_tag) != 0; }
+
+    const Rational* wide() const { return reinterpret_cast<const Rational*>(static_cast<uintptr_t>(bits_ & ~escape_tag)); }
+
+    int64_t packed_numerator() const { return static_cast<int32_t>(static_cast<uint32_t>(bits_ >> 32)); }
+    uint64_t packed_denominator() const { return (bits_ >> 1) & 0x7FFFFFFFu; }
+
+    static uint64_t encode(const Rational& value) {
+        if (fits_packed(value.numerator_, value.denominator_)) return pack(value.numerator_, value.denominator_);
+        return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(new Rational(value))) | escape_tag;
+    }
+
+    // num/den уже сокращены.
+    static PackedRational from_reduced(int64_t num, uint64_t den) {
+        PackedRational result;
+        if (fits_packed(num, den)) {
+            result.bits_ = pack(num, den);
+        } else {
+            Rational wide;
+            wide.numerator_ = num;
+            wide.denominator_ = den;
+            result.bits_ = encode(wide);
+        }
+        return result;
+    }
+
+    static PackedRational reduce(int64_t num, uint64_t den) {
+        if (num == 0) return PackedRational();
+
+        uint64_t gcd_val = binary_gcd(Rational::abs_value(num), den);
+        return from_reduced(num / static_cast<int64_t>(gcd_val), den / gcd_val);
+    }
+
+    void release() {
+        if (is_escaped()) delete wide();
+    }
+
+public:
+    PackedRational() : bits_(pack(0, 1)) {}
+
+    PackedRational(int64_t n) : bits_(encode(Rational(n))) {}
+
+    PackedRational(int64_t num, int64_t denom) : bits_(encode(Rational(num, denom))) {}
+
+    PackedRational(const Rational& value) : bits_(encode(value)) {}
+
+    PackedRational(const PackedRational& other)
+        : bits_(other.is_escaped() ? encode(*other.wide()) : other.bits_) {}
+
+    PackedRational(PackedRational&& other) noexcept : bits_(other.bits_) {
+        other.bits_ = pack(0, 1);
+    }
+
+    PackedRational& operator=(const PackedRational& other) {
+        if (this != &other) {
+            uint64_t bits = other.is_escaped() ? encode(*other.wide()) : other.bits_;
+            release();
+            bits_ = bits;
+        }
+        return *this;
+    }
+
+    PackedRational& operator=(PackedRational&& other) noexcept {
+        if (this != &other) {
+            release();
+            bits_ = other.bits_;
+            other.bits_ = pack(0, 1);
+        }
+        return *this;
+    }
+
+    ~PackedRational() { release(); }
+
+    // true, если значение хранится в самом слове без выделения памяти.
+    bool is_packed() const { return !is_escaped(); }
+
+    Rational value() const {
+        if (is_escaped()) return *wide();
+
+        Rational result;
+        result.numerator_ = packed_numerator();
+        result.denominator_ = packed_denominator();
+        return result;
+    }
+
+    int64_t numerator() const { return is_escaped() ? wide()->numerator() : packed_numerator(); }
+    uint64_t denominator() const { return is_escaped() ? wide()->denominator() : packed_denominator(); }
+
+    explicit operator Rational() const { return value(); }
+
+    explicit operator double() const {
+        return static_cast<double>(numerator()) / static_cast<double>(denominator());
+    }
+
+    std::string str() const { return value().str(); }
+
+    PackedRational operator-() const {
+        if (is_escaped()) return PackedRational(-*wide());
+        return from_reduced(-packed_numerator(), packed_denominator());
+    }
+
+    // При |числителе| <= 2^31 и знаменателе < 2^31 промежуточные значения
+    // помещаются в int64_t, поэтому проверки переполнения не нужны.
+    PackedRational operator+(const PackedRational& other) const {
+        if (is_escaped() || other.is_escaped()) return PackedRational(value() + other.value());
+
+        int64_t a_den = static_cast<int64_t>(packed_denominator());
+        int64_t b_den = static_cast<int64_t>(other.packed_denominator());
+        return reduce(packed_numerator() * b_den + other.packed_numerator() * a_den,
+                      packed_denominator() * other.packed_denominator());
+    }
+
+    PackedRational& operator+=(const PackedRational& other) {
+        *this = *this + other;
+        return *this;
+    }
+
+    PackedRational operator-(const PackedRational& other) const {
+        if (is_escaped() || other.is_escaped()) return PackedRational(value() - other.value());
+
+        int64_t a_den = static_cast<int64_t>(packed_denominator());
+        int64_t b_den = static_cast<int64_t>(other.packed_denominator());
+        return reduce(packed_numerator() * b_den - other.packed_numerator() * a_den,
+                      packed_denominator() * other.packed_denominator());
+    }
+
+    PackedRational& operator-=(const PackedRational& other) {
+        *this = *this - other;
+        return *this;
+    }
+
+    PackedRational operator*(const PackedRational& other) const {
+        if (is_escaped() || other.is_escaped()) return PackedRational(value() * other.value());
+
+        return reduce(packed_numerator() * other.packed_numerator(),
+                      packed_denominator() * other.packed_denominator());
+    }
+
+    PackedRational& operator*=(const PackedRational& other) {
+        *this = *this * other;
+        return *this;
+    }
+
+    PackedRational operator/(const PackedRational& other) const {
+        if (is_escaped() || other.is_escaped()) return PackedRational(value() / other.value());
+        if (other.packed_numerator() == 0) return PackedRational();
+
+        int64_t num = packed_numerator() * static_cast<int64_t>(other.packed_denominator());
+        int64_t den = other.packed_numerator() * static_cast<int64_t>(packed_denominator());
+        return den < 0 ? reduce(-num, static_cast<uint64_t>(-den)) : reduce(num, static_cast<uint64_t>(den));
+    }
+
+    PackedRational& operator/=(const PackedRational& other) {
+        *this = *this / other;
+        return *this;
+    }
+
+    bool operator==(const PackedRational& other) const {
+        if (!is_escaped() || !other.is_escaped()) return bits_ == other.bits_;
+        return *wide() == *other.wide();
+    }
+
+    bool operator!=(const PackedRational& other) const {
+        return !(*this == other);
+    }
+
+    bool operator<(const PackedRational& other) const {
+        if (is_escaped() || other.is_escaped()) return value() < other.value();
+
+        return packed_numerator() * static_cast<int64_t>(other.packed_denominator()) <
+               other.packed_numerator() * static_cast<int64_t>(packed_denominator());
+    }
+
+    bool operator<=(const PackedRational& other) const {
+        return !(other < *this);
+    }
+
+    bool operator>(const PackedRational& other) const {
+        return other < *this;
+    }
+
+    bool operator>=(const PackedRational& other) const {
+        return !(*this < other);
+    }
+};
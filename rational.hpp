@@ -0,0 +1,905 @@
+#pragma once
+
+#include <version>
+#include <compare>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <limits>
+#include <charconv>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <vector>
+#include <system_error>
+#include <type_traits>
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
+
+#include "checked.hpp"
+#include "binary_gcd.hpp"
+#include "rational_counters.hpp"
+#include "bigint.hpp"
+
+#ifndef __SIZEOF_INT128__
+#error "Rational требует поддержки __int128"
+#endif
+
+__extension__ typedef __int128 int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+
+// Счётчики кеша сокращения текущего потока (см. Rational::cached).
+struct ReduceCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+class Rational {
+private:
+    friend class RationalAccumulator;
+    friend class RationalSoA;
+    friend class ExactRational;
+    friend class RationalCodec;
+    friend class PackedRational;
+    friend class RationalMatrix;
+    friend class FusedEvaluator;
+    friend class ConcurrentRationalSum;
+    friend class ContinuedFraction;
+    template <typename T> friend class RationalMap;
+
+    int64_t numerator_;
+    uint64_t denominator_;
+
+    // Конструктор без сокращения для результатов, которые заведомо несократимы.
+    struct Canonical {};
+
+    constexpr Rational(int64_t num, uint64_t den, Canonical) : numerator_(num), denominator_(den) {}
+
+    static constexpr uint64_t abs_value(int64_t v) {
+        return v < 0 ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+    }
+
+    constexpr void reduce() {
+        RATIONAL_COUNT(reduce);
+        if (numerator_ == 0) {
+            denominator_ = 1;
+            return;
+        }
+        
+        uint64_t gcd_val = binary_gcd(abs_value(numerator_), denominator_);
+        numerator_ /= static_cast<int64_t>(gcd_val);
+        denominator_ /= gcd_val;
+    }
+
+    // Кеш прямого отображения: пара (числитель, знаменатель) до сокращения и
+    // результат. Знаменатель 0 у пустой записи никогда не совпадёт с ключом.
+    struct ReduceCache {
+        static constexpr int bits = 10;
+
+        struct Entry {
+            int64_t numerator = 0;
+            uint64_t denominator = 0;
+            int64_t reduced_numerator = 0;
+            uint64_t reduced_denominator = 0;
+        };
+
+        Entry entries[size_t(1) << bits];
+        ReduceCacheStats stats;
+    };
+
+    static ReduceCache& reduce_cache() {
+        thread_local ReduceCache cache;
+        return cache;
+    }
+
+    void reduce_cached() {
+        ReduceCache& cache = reduce_cache();
+        uint64_t h = (static_cast<uint64_t>(numerator_) * 0x9E3779B97F4A7C15ull ^ denominator_) * 0xFF51AFD7ED558CCDull;
+        ReduceCache::Entry& entry = cache.entries[h >> (64 - ReduceCache::bits)];
+        if (entry.numerator == numerator_ && entry.denominator == denominator_) {
+            ++cache.stats.hits;
+            numerator_ = entry.reduced_numerator;
+            denominator_ = entry.reduced_denominator;
+            return;
+        }
+
+        ++cache.stats.misses;
+        entry.numerator = numerator_;
+        entry.denominator = denominator_;
+        reduce();
+        entry.reduced_numerator = numerator_;
+        entry.reduced_denominator = denominator_;
+    }
+
+    static constexpr int ctz_wide(uint128_t x) {
+        uint64_t low = static_cast<uint64_t>(x);
+        return low != 0 ? ctz64(low) : 64 + ctz64(static_cast<uint64_t>(x >> 64));
+    }
+
+    static constexpr uint128_t gcd_wide(uint128_t a, uint128_t b) {
+        if (((a | b) >> 64) == 0) return binary_gcd(static_cast<uint64_t>(a), static_cast<uint64_t>(b));
+        if (a == 0) return b;
+        if (b == 0) return a;
+
+        int shift = ctz_wide(a | b);
+        a >>= ctz_wide(a);
+        b >>= ctz_wide(b);
+        while (a != b) {
+            RATIONAL_COUNT(gcd_iterations);
+            uint128_t low = a < b ? a : b;
+            uint128_t diff = a < b ? b - a : a - b;
+            a = low;
+            b = diff >> ctz_wide(diff);
+        }
+        return a << shift;
+    }
+
+    // Значение представимо, если и оно, и противоположное помещаются в 64 бита.
+    static constexpr bool fits(int128_t num, uint128_t den) {
+        return num >= -INT64_MAX && num <= INT64_MAX && den <= INT64_MAX;
+    }
+
+    // Точный результат уже сокращён; если он не помещается в 64 бита, значение
+    // усекается и возвращается false.
+    static constexpr bool narrow(int128_t num, uint128_t den, Rational& out) {
+        if (num == 0) {
+            out = Rational();
+            return true;
+        }
+
+        out.numerator_ = static_cast<int64_t>(num);
+        out.denominator_ = static_cast<uint64_t>(den);
+        return fits(num, den);
+    }
+
+    static constexpr bool from_wide(int128_t num, uint128_t den, Rational& out) {
+        uint128_t abs_num = num < 0 ? 0 - static_cast<uint128_t>(num) : static_cast<uint128_t>(num);
+        uint128_t gcd_val = gcd_wide(abs_num, den);
+        return narrow(num / static_cast<int128_t>(gcd_val), den / gcd_val, out);
+    }
+
+    // Номер корзины знаменателя в таблице размера size (степень двойки).
+    static size_t bucket(uint64_t den, size_t size) {
+        return static_cast<size_t>((den * 0x9E3779B97F4A7C15ull) >> 32) & (size - 1);
+    }
+
+    // a + b или, при subtract, a - b: в 128 битах -INT64_MIN тоже представим.
+    static constexpr bool add_safe(const Rational& a, const Rational& b, Rational& out, bool subtract = false) {
+        uint64_t gcd_denominators = binary_gcd(a.denominator_, b.denominator_);
+        uint64_t simp_den1 = a.denominator_ / gcd_denominators;
+        uint64_t simp_den2 = b.denominator_ / gcd_denominators;
+
+        int128_t b_numerator = subtract ? -static_cast<int128_t>(b.numerator_) : static_cast<int128_t>(b.numerator_);
+        // Каждое произведение меньше 2^127 по модулю; сумма может не поместиться
+        // только у уже усечённых операндов со знаменателем больше INT64_MAX, и
+        // тогда она усекается по модулю 2^128.
+        int128_t new_numerator = static_cast<int128_t>(static_cast<uint128_t>(static_cast<int128_t>(a.numerator_) * simp_den2) +
+                                                       static_cast<uint128_t>(b_numerator * simp_den1));
+        uint128_t new_denominator = static_cast<uint128_t>(a.denominator_) * simp_den2;
+
+        return from_wide(new_numerator, new_denominator, out);
+    }
+
+    static constexpr bool try_add(const Rational& a, const Rational& b, Rational& out) {
+        int64_t term1, term2, new_numerator;
+        int64_t new_denominator;
+        if (checked::mul(a.numerator_, b.denominator_, term1) ||
+            checked::mul(b.numerator_, a.denominator_, term2) ||
+            checked::add(term1, term2, new_numerator) ||
+            checked::mul(a.denominator_, b.denominator_, new_denominator)) {
+            RATIONAL_COUNT(add_safe);
+            return add_safe(a, b, out);
+        }
+
+        RATIONAL_COUNT(fast_path);
+        out = Rational(new_numerator, new_denominator);
+        return out.numerator_ != std::numeric_limits<int64_t>::min();
+    }
+
+    static constexpr bool try_mul(const Rational& a, const Rational& b, Rational& out) {
+        int64_t new_numerator;
+        int64_t new_denominator;
+        if (checked::mul(a.numerator_, b.numerator_, new_numerator) ||
+            checked::mul(a.denominator_, b.denominator_, new_denominator)) {
+            RATIONAL_COUNT(cross_cancel);
+            uint64_t gcd1 = binary_gcd(abs_value(a.numerator_), b.denominator_);
+            uint64_t gcd2 = binary_gcd(abs_value(b.numerator_), a.denominator_);
+
+            // Делим в 128 битах: НОД с INT64_MIN может быть равен 2^63.
+            return narrow(static_cast<int128_t>(a.numerator_) / gcd1 * (static_cast<int128_t>(b.numerator_) / gcd2),
+                          static_cast<uint128_t>(a.denominator_ / gcd2) * (b.denominator_ / gcd1), out);
+        }
+
+        RATIONAL_COUNT(fast_path);
+        out = Rational(new_numerator, new_denominator);
+        return out.numerator_ != std::numeric_limits<int64_t>::min();
+    }
+
+    // Ближайшая к n / d (n >= 0, d > 0, d < 2^127) дробь p / q с q <= max_den
+    // (1 <= max_den < 2^64): подходящие дроби цепной дроби и лучшая промежуточная.
+    // При равенстве расстояний выбирается подходящая. p / q несократима.
+    static constexpr void best_approximation(uint128_t n, uint128_t d, uint64_t max_den, uint128_t& p, uint128_t& q) {
+        uint128_t p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+        // Знаменатели подходящих дробей растут не медленнее чисел Фибоначчи,
+        // так что до 2^63 доходит меньше 100 шагов.
+        for (int step = 0; step < 100; ++step) {
+            // Остатки быстро становятся 64-битными, а 64-битное деление намного дешевле.
+            uint128_t a = ((n | d) >> 64) == 0 ? static_cast<uint64_t>(n) / static_cast<uint64_t>(d) : n / d;
+            // q0 + a*q1 > max_den; при a >= 2^64 это заведомо так, иначе произведение помещается в 128 бит.
+            if (q1 != 0 && ((a >> 64) != 0 || a * q1 > max_den - q0)) break;
+
+            uint128_t p2 = p0 + a * p1, q2 = q0 + a * q1;
+            p0 = p1;
+            q0 = q1;
+            p1 = p2;
+            q1 = q2;
+
+            uint128_t r = n - a * d;
+            n = d;
+            d = r;
+            if (d == 0) break;
+        }
+
+        // Кроме последней подходящей дроби p1/q1 кандидатом служит промежуточная
+        // (p0 + k*p1) / (q0 + k*q1) с наибольшим допустимым k. Так как
+        // x = (p1*n + p0*d) / (q1*n + q0*d), расстояния до x равны
+        // d / (q1*Q) и (n - k*d) / ((q0 + k*q1)*Q); оба произведения ниже
+        // не превосходят исходного знаменателя.
+        p = p1;
+        q = q1;
+        if (d != 0) {
+            uint128_t k = (max_den - static_cast<uint64_t>(q0)) / static_cast<uint64_t>(q1);
+            if ((n - k * d) * q1 < d * (q0 + k * q1)) {
+                p = p0 + k * p1;
+                q = q0 + k * q1;
+            }
+        }
+    }
+
+    enum class Rounding { floor, ceil, nearest };
+
+    // Модуль частного n / d со знаком negative, округлённого по mode
+    // (nearest — половина от нуля).
+    static constexpr uint128_t rounded_quotient(uint128_t n, uint128_t d, bool negative, Rounding mode) {
+        uint128_t q, r;
+        if (((n | d) >> 64) == 0) {
+            q = static_cast<uint64_t>(n) / static_cast<uint64_t>(d);
+            r = static_cast<uint64_t>(n) % static_cast<uint64_t>(d);
+        } else {
+            q = n / d;
+            r = n % d;
+        }
+        bool up = mode == Rounding::nearest ? r >= d - r : r != 0 && (mode == Rounding::ceil) != negative;
+        return q + up;
+    }
+
+    constexpr int64_t rounded(Rounding mode) const {
+        uint64_t m = static_cast<uint64_t>(rounded_quotient(abs_value(numerator_), denominator_, numerator_ < 0, mode));
+        return static_cast<int64_t>(numerator_ < 0 ? 0 - m : m);
+    }
+
+    constexpr Rational rounded_to(uint64_t den, Rounding mode) const {
+        den = std::clamp<uint64_t>(den, 1, std::numeric_limits<int64_t>::max());
+        uint128_t m = rounded_quotient(static_cast<uint128_t>(abs_value(numerator_)) * den, denominator_,
+                                       numerator_ < 0, mode);
+        Rational result;
+        from_wide(numerator_ < 0 ? -static_cast<int128_t>(m) : static_cast<int128_t>(m), den, result);
+        return result;
+    }
+
+    // Обратная к ненулевой несократимой дроби тоже несократима: достаточно
+    // переставить поля и перенести знак в числитель. Знак переносится по модулю
+    // 2^64, поэтому у INT64_MIN / d обратная -d / 2^63 получается точно (такой
+    // знаменатель умножение принимает), а непредставимая усекается.
+    constexpr Rational reciprocal() const {
+        uint64_t den = numerator_ < 0 ? 0 - denominator_ : denominator_;
+        return Rational(static_cast<int64_t>(den), abs_value(numerator_), Canonical());
+    }
+
+public:
+    constexpr Rational() : numerator_(0), denominator_(1) {}
+    
+    constexpr Rational(int64_t n) : numerator_(n), denominator_(1) {}
+    
+    constexpr Rational(int64_t num, int64_t denom) {
+        if (denom == 0) {
+            denominator_ = 1;
+            numerator_ = 0;
+        } else if (denom < 0) {
+            numerator_ = -num;
+            denominator_ = -denom;
+        } else {
+            numerator_ = num;
+            denominator_ = denom;
+        }
+#ifdef RATIONAL_REDUCE_CACHE
+        if (!std::is_constant_evaluated()) {
+            reduce_cached();
+            return;
+        }
+#endif
+        reduce();
+    }
+
+    // То же, что Rational(num, denom), но сокращение идёт через кеш потока:
+    // повторная пара обходится одним поиском вместо НОД. С макросом
+    // RATIONAL_REDUCE_CACHE так работает и сам конструктор.
+    static Rational cached(int64_t num, int64_t denom) {
+        Rational result;
+        if (denom == 0) return result;
+        result.numerator_ = denom < 0 ? -num : num;
+        result.denominator_ = denom < 0 ? -denom : denom;
+        result.reduce_cached();
+        return result;
+    }
+
+    static ReduceCacheStats reduce_cache_stats() { return reduce_cache().stats; }
+
+    static void reset_reduce_cache() { reduce_cache() = ReduceCache(); }
+    
+    constexpr int64_t numerator() const { return numerator_; }
+    constexpr uint64_t denominator() const { return denominator_; }
+    
+    // Быстрое приближение: каждое поле округляется отдельно, поэтому при
+    // числителе или знаменателе больше 2^53 ошибка может превысить пол-ulp.
+    explicit constexpr operator double() const {
+        return static_cast<double>(numerator_) / static_cast<double>(denominator_);
+    }
+
+    // Ближайший к значению double (округление к чётному).
+    double to_double() const {
+        uint64_t a = abs_value(numerator_), b = denominator_;
+        if ((a >> 53) == 0 && (b >> 53) == 0) {
+            // Оба поля точны в double, а деление IEEE округляет корректно.
+            return static_cast<double>(numerator_) / static_cast<double>(b);
+        }
+
+        // Частное q = a * 2^shift / b берётся с 55-56 значащими битами, остаток —
+        // как «липкий» бит для округления.
+        int shift = 55 - (std::bit_width(a) - std::bit_width(b));
+        uint128_t num = a, den = b;
+        if (shift >= 0) {
+            num <<= shift;
+        } else {
+            den <<= -shift;
+        }
+        uint128_t q = num / den;
+        bool sticky = num % den != 0;
+
+        int drop = static_cast<int>(std::bit_width(static_cast<uint64_t>(q))) - 53;
+        uint64_t mantissa = static_cast<uint64_t>(q >> drop);
+        uint64_t rest = static_cast<uint64_t>(q) & ((uint64_t(1) << drop) - 1);
+        uint64_t half = uint64_t(1) << (drop - 1);
+        if (rest > half || (rest == half && (sticky || (mantissa & 1) != 0))) ++mantissa;
+
+        double result = std::ldexp(static_cast<double>(mantissa), drop - shift);
+        return numerator_ < 0 ? -result : result;
+    }
+
+    // Ближайшая к value дробь со знаменателем не больше max_den (цепные дроби с
+    // проверкой промежуточных подходящих дробей). Возвращает false для NaN,
+    // бесконечностей и |value| >= 2^63; out при этом не меняется.
+    static bool from_double(double value, uint64_t max_den, Rational& out) {
+        if (!std::isfinite(value) || std::fabs(value) >= 0x1p63) return false;
+        max_den = std::clamp<uint64_t>(max_den, 1, std::numeric_limits<int64_t>::max());
+
+        // value = m * 2^exp точно; дроби меньше 2^-64 ближе к 0, чем к 1/max_den.
+        int exp;
+        double fraction = std::frexp(std::fabs(value), &exp);
+        if (fraction == 0 || exp < -64) {
+            out = Rational();
+            return true;
+        }
+        uint64_t m = static_cast<uint64_t>(std::ldexp(fraction, 53));
+        exp -= 53;
+        if (exp >= 0) {
+            int64_t whole = static_cast<int64_t>(m << exp);
+            out = Rational(value < 0 ? -whole : whole);
+            return true;
+        }
+
+        // Числитель результата не больше |value| * q + 1, поэтому при
+        // q <= INT64_MAX / (floor(|value|) + 1) он помещается в int64_t.
+        uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) /
+                         (static_cast<uint64_t>(std::fabs(value)) + 1);
+        max_den = std::min(max_den, limit);
+
+        uint128_t best_p, best_q;
+        best_approximation(m, uint128_t(1) << -exp, max_den, best_p, best_q);
+
+        // Подходящие и промежуточные дроби несократимы.
+        int64_t num = static_cast<int64_t>(best_p);
+        out = Rational(value < 0 ? -num : num, static_cast<uint64_t>(best_q), Canonical());
+        return true;
+    }
+
+    // Ближайшая дробь со знаменателем не больше max_den (0 считается за 1).
+    // Считается цепными дробями прямо по полям за O(log) шагов. Например,
+    // limit_denominator(INT32_MAX) даёт значение для систем с 32-битными
+    // знаменателями, а дроби с малыми полями складываются быстрым путём operator+.
+    constexpr Rational limit_denominator(uint64_t max_den) const {
+        if (denominator_ <= max_den) return *this;
+        max_den = std::max<uint64_t>(max_den, 1);
+
+        // q < denominator_, поэтому |p| <= |x| * q + 1 не больше |numerator_|.
+        uint128_t p, q;
+        best_approximation(abs_value(numerator_), denominator_, max_den, p, q);
+        uint64_t magnitude = static_cast<uint64_t>(p);
+        return Rational(static_cast<int64_t>(numerator_ < 0 ? 0 - magnitude : magnitude), static_cast<uint64_t>(q),
+                        Canonical());
+    }
+
+    // Округление до целого: к минус бесконечности, к плюс бесконечности и до
+    // ближайшего (половина — от нуля).
+    constexpr int64_t floor() const { return rounded(Rounding::floor); }
+    constexpr int64_t ceil() const { return rounded(Rounding::ceil); }
+    constexpr int64_t round() const { return rounded(Rounding::nearest); }
+
+    // То же до кратного 1/den (den от 1 до INT64_MAX): результат k/den в
+    // сокращённом виде. Если он не помещается в 64 бита, то усекается, как у
+    // арифметических операций.
+    constexpr Rational floor_to(uint64_t den) const { return rounded_to(den, Rounding::floor); }
+    constexpr Rational ceil_to(uint64_t den) const { return rounded_to(den, Rounding::ceil); }
+    constexpr Rational round_to(uint64_t den) const { return rounded_to(den, Rounding::nearest); }
+    
+    // Длина самой длинной записи: "-9223372036854775808/18446744073709551615".
+    static constexpr size_t max_chars = 41;
+
+    // Записывает "n" или "n/d" в [first, last) по правилам std::to_chars:
+    // при нехватке места возвращает {last, std::errc::value_too_large}.
+    std::to_chars_result to_chars(char* first, char* last) const {
+        std::to_chars_result result = std::to_chars(first, last, numerator_);
+        if (result.ec != std::errc() || denominator_ == 1) return result;
+
+        if (result.ptr == last) return {last, std::errc::value_too_large};
+        *result.ptr++ = '/';
+        return std::to_chars(result.ptr, last, denominator_);
+    }
+
+    template <typename OutputIt>
+    OutputIt format_to(OutputIt out) const {
+        char buffer[max_chars];
+        std::to_chars_result result = to_chars(buffer, buffer + max_chars);
+        return std::copy(buffer, result.ptr, out);
+    }
+
+    std::string str() const {
+        char buffer[max_chars];
+        std::to_chars_result result = to_chars(buffer, buffer + max_chars);
+        return std::string(buffer, result.ptr);
+    }
+
+    // Разбирает "n", "n/d" или десятичную запись "n.ddd" без учёта локали и без
+    // выделения памяти. Как и std::from_chars, читает самый длинный корректный
+    // префикс; при ошибке возвращает {first, std::errc::invalid_argument} или
+    // std::errc::result_out_of_range, не изменяя value.
+    static std::from_chars_result from_chars(const char* first, const char* last, Rational& value) {
+        const char* p = first;
+        bool negative = p != last && *p == '-';
+        if (negative) ++p;
+
+        uint64_t magnitude;
+        std::from_chars_result parsed = std::from_chars(p, last, magnitude);
+        if (parsed.ec == std::errc::invalid_argument) return {first, parsed.ec};
+        if (parsed.ec != std::errc()) return parsed;
+        p = parsed.ptr;
+
+        uint64_t den = 1;
+        if (p != last && *p == '/') {
+            std::from_chars_result den_parsed = std::from_chars(p + 1, last, den);
+            if (den_parsed.ec == std::errc()) {
+                if (den == 0) return {first, std::errc::invalid_argument};
+                p = den_parsed.ptr;
+            } else if (den_parsed.ec == std::errc::result_out_of_range) {
+                return den_parsed;
+            } else {
+                den = 1;
+            }
+        } else if (p != last && *p == '.') {
+            const char* digits = p + 1;
+            const char* digits_end = digits;
+            while (digits_end != last && *digits_end >= '0' && *digits_end <= '9') ++digits_end;
+            if (digits_end != digits) {
+                p = digits_end;
+                while (digits_end != digits && digits_end[-1] == '0') --digits_end;
+                for (const char* d = digits; d != digits_end; ++d) {
+                    if (checked::mul(magnitude, uint64_t(10), magnitude) ||
+                        checked::add(magnitude, static_cast<uint64_t>(*d - '0'), magnitude) ||
+                        checked::mul(den, uint64_t(10), den)) {
+                        return {p, std::errc::result_out_of_range};
+                    }
+                }
+            }
+        }
+
+        uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + (negative ? 1 : 0);
+        if (magnitude > limit || den > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+            return {p, std::errc::result_out_of_range};
+        }
+
+        int64_t num = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+        value = Rational(num, static_cast<int64_t>(den));
+        return {p, std::errc()};
+    }
+    
+    // -INT64_MIN не помещается в int64_t и, как любое переполнение, усекается
+    // (остаётся INT64_MIN).
+    constexpr Rational operator-() const {
+        return Rational(static_cast<int64_t>(0 - static_cast<uint64_t>(numerator_)), denominator_, Canonical());
+    }
+
+    constexpr Rational operator+(const Rational& other) const {
+        Rational result;
+        if (!try_add(*this, other, result)) RATIONAL_COUNT(overflow);
+        return result;
+    }
+    
+    constexpr Rational& operator+=(const Rational& other) {
+        if (!try_add(*this, other, *this)) RATIONAL_COUNT(overflow);
+        return *this;
+    }
+
+    constexpr Rational operator-(const Rational& other) const {
+        if (other.numerator_ != std::numeric_limits<int64_t>::min()) return *this + (-other);
+
+        Rational result;
+        if (!add_safe(*this, other, result, true)) RATIONAL_COUNT(overflow);
+        return result;
+    }
+    
+    constexpr Rational& operator-=(const Rational& other) {
+        if (other.numerator_ != std::numeric_limits<int64_t>::min()) return *this += -other;
+
+        if (!add_safe(*this, other, *this, true)) RATIONAL_COUNT(overflow);
+        return *this;
+    }
+
+    constexpr Rational operator*(const Rational& other) const {
+        Rational result;
+        if (!try_mul(*this, other, result)) RATIONAL_COUNT(overflow);
+        return result;
+    }
+    
+    constexpr Rational& operator*=(const Rational& other) {
+        if (!try_mul(*this, other, *this)) RATIONAL_COUNT(overflow);
+        return *this;
+    }
+
+    constexpr Rational operator/(const Rational& other) const {
+        if (other.numerator_ == 0) {
+            return Rational(0); 
+        }
+        return *this * other.reciprocal();
+    }
+    
+    constexpr Rational& operator/=(const Rational& other) {
+        if (other.numerator_ == 0) {
+            *this = Rational(0);
+            return *this;
+        }
+        return *this *= other.reciprocal();
+    }
+
+    // Операции с целым числом. Сложение не требует НОД: gcd(n + k*d, d) = gcd(n, d) = 1;
+    // при умножении и делении достаточно сократить k с тем полем, на которое
+    // оно умножается. Если промежуточный результат переполнился бы, операция
+    // выполняется как с Rational(k).
+    constexpr Rational operator+(int64_t k) const {
+        int64_t shift, new_numerator;
+        if (checked::mul(k, denominator_, shift) || checked::add(numerator_, shift, new_numerator) ||
+            new_numerator == std::numeric_limits<int64_t>::min()) {
+            return *this + Rational(k);
+        }
+
+        RATIONAL_COUNT(fast_path);
+        return Rational(new_numerator, denominator_, Canonical());
+    }
+
+    constexpr Rational operator-(int64_t k) const {
+        if (k == std::numeric_limits<int64_t>::min()) return *this - Rational(k);
+        return *this + (-k);
+    }
+
+    constexpr Rational operator*(int64_t k) const {
+        if (k == 0) return Rational();
+        if (k == std::numeric_limits<int64_t>::min()) return *this * Rational(k);
+
+        // Одно деление сводит НОД к операндам размера k: обычно k намного меньше знаменателя.
+        uint64_t gcd_val = binary_gcd(abs_value(k), denominator_ % abs_value(k));
+        int64_t new_numerator;
+        if (checked::mul(numerator_, k / static_cast<int64_t>(gcd_val), new_numerator) ||
+            new_numerator == std::numeric_limits<int64_t>::min()) {
+            return *this * Rational(k);
+        }
+
+        RATIONAL_COUNT(fast_path);
+        return Rational(new_numerator, denominator_ / gcd_val, Canonical());
+    }
+
+    constexpr Rational operator/(int64_t k) const {
+        if (k == 0) return Rational(0);
+        if (k == std::numeric_limits<int64_t>::min()) return *this / Rational(k);
+
+        uint64_t gcd_val = binary_gcd(abs_value(k), abs_value(numerator_) % abs_value(k));
+        int64_t new_denominator;
+        if (checked::mul(denominator_, abs_value(k) / gcd_val, new_denominator)) {
+            return *this / Rational(k);
+        }
+
+        int64_t new_numerator = numerator_ / static_cast<int64_t>(gcd_val);
+        if (k < 0 && new_numerator == std::numeric_limits<int64_t>::min()) return *this / Rational(k);
+
+        RATIONAL_COUNT(fast_path);
+        return Rational(k < 0 ? -new_numerator : new_numerator, static_cast<uint64_t>(new_denominator), Canonical());
+    }
+
+    constexpr Rational& operator+=(int64_t k) {
+        *this = *this + k;
+        return *this;
+    }
+
+    constexpr Rational& operator-=(int64_t k) {
+        *this = *this - k;
+        return *this;
+    }
+
+    constexpr Rational& operator*=(int64_t k) {
+        *this = *this * k;
+        return *this;
+    }
+
+    constexpr Rational& operator/=(int64_t k) {
+        *this = *this / k;
+        return *this;
+    }
+
+    friend constexpr Rational operator+(int64_t k, const Rational& r) {
+        return r + k;
+    }
+
+    friend constexpr Rational operator-(int64_t k, const Rational& r) {
+        return -r + k;
+    }
+
+    friend constexpr Rational operator*(int64_t k, const Rational& r) {
+        return r * k;
+    }
+
+    // k / r = (d / n) * k.
+    friend constexpr Rational operator/(int64_t k, const Rational& r) {
+        if (r.numerator_ == 0) return Rational(0);
+        return r.reciprocal() * k;
+    }
+
+    // Значение 128-битного числа как BigInt.
+    static BigInt big_from_wide(int128_t value) {
+        uint128_t mag = value < 0 ? 0 - static_cast<uint128_t>(value) : static_cast<uint128_t>(value);
+        BigInt two32 = BigInt::from_unsigned(uint64_t(1) << 32);
+        BigInt result = BigInt::from_unsigned(static_cast<uint64_t>(mag >> 64)) * two32 * two32 +
+                        BigInt::from_unsigned(static_cast<uint64_t>(mag));
+        return value < 0 ? -result : result;
+    }
+
+    // Точная сумма корзин sums[i] / dens[i] (dens[i] != 0). Если она не
+    // помещается в Rational, сокращённое значение усекается, как у narrow,
+    // и возвращается false.
+    static bool sum_buckets_exact(const std::vector<uint64_t>& dens, const std::vector<int128_t>& sums, Rational& out) {
+        BigInt num(0), den(1);
+        for (size_t i = 0; i < dens.size(); ++i) {
+            if (dens[i] == 0 || sums[i] == 0) continue;
+            BigInt d = BigInt::from_unsigned(dens[i]);
+            num = num * d + big_from_wide(sums[i]) * den;
+            den = den * d;
+        }
+        if (num.is_zero()) {
+            out = Rational();
+            return true;
+        }
+
+        BigInt gcd_val = BigInt::gcd(num.abs(), den);
+        num = num / gcd_val;
+        den = den / gcd_val;
+        int64_t n, d;
+        if (!num.to_int64(n) || !den.to_int64(d) || n == std::numeric_limits<int64_t>::min()) {
+            out.numerator_ = static_cast<int64_t>(num.low_bits());
+            out.denominator_ = den.low_bits();
+            return false;
+        }
+        out = Rational(n, static_cast<uint64_t>(d), Canonical{});
+        return true;
+    }
+
+    // Сумма диапазона дробей. Слагаемые с одинаковым знаменателем складываются
+    // целочисленно (в 128 битах) в корзине этого знаменателя; затем корзины,
+    // упорядоченные по знаменателю, попарно сливаются обычным сложением.
+    // Если при слиянии корзин промежуточная сумма не поместилась в 64 бита,
+    // корзины складываются заново точно, на BigInt, и результат не зависит от
+    // промежуточных переполнений. Если не помещается и сама точная сумма, от
+    // её сокращённых числителя и знаменателя остаются младшие 64 бита, как
+    // у from_wide.
+    template <typename It>
+    static Rational sum(It first, It last) {
+        std::vector<uint64_t> dens(16, 0);
+        std::vector<int128_t> sums(16, 0);
+        size_t used = 0;
+        size_t slot = 0;
+
+        for (; first != last; ++first) {
+            const Rational& value = *first;
+            if (dens[slot] != value.denominator_) {
+                if (2 * (used + 1) > dens.size()) {
+                    std::vector<uint64_t> old_dens;
+                    std::vector<int128_t> old_sums;
+                    old_dens.swap(dens);
+                    old_sums.swap(sums);
+                    dens.assign(old_dens.size() * 2, 0);
+                    sums.assign(old_sums.size() * 2, 0);
+                    for (size_t i = 0; i < old_dens.size(); ++i) {
+                        if (old_dens[i] == 0) continue;
+                        size_t j = bucket(old_dens[i], dens.size());
+                        while (dens[j] != 0) j = (j + 1) & (dens.size() - 1);
+                        dens[j] = old_dens[i];
+                        sums[j] = old_sums[i];
+                    }
+                }
+
+                slot = bucket(value.denominator_, dens.size());
+                while (dens[slot] != 0 && dens[slot] != value.denominator_) slot = (slot + 1) & (dens.size() - 1);
+                if (dens[slot] == 0) {
+                    dens[slot] = value.denominator_;
+                    ++used;
+                }
+            }
+            sums[slot] += value.numerator_;
+        }
+
+        std::vector<Rational> terms;
+        terms.reserve(used);
+        bool exact = true;
+        for (size_t i = 0; i < dens.size(); ++i) {
+            if (dens[i] != 0) {
+                Rational term;
+                exact &= from_wide(sums[i], dens[i], term);
+                terms.push_back(term);
+            }
+        }
+        std::sort(terms.begin(), terms.end(),
+                  [](const Rational& a, const Rational& b) { return a.denominator_ < b.denominator_; });
+
+        if (terms.empty()) return Rational();
+        for (size_t width = 1; width < terms.size(); width *= 2) {
+            for (size_t i = 0; i + width < terms.size(); i += 2 * width) {
+                exact &= try_add(terms[i], terms[i + width], terms[i]);
+            }
+        }
+
+        if (exact) return terms[0];
+        Rational result;
+        if (!sum_buckets_exact(dens, sums, result)) RATIONAL_COUNT(overflow);
+        return result;
+    }
+
+    constexpr bool operator==(const Rational& other) const {
+        return numerator_ == other.numerator_ && denominator_ == other.denominator_;
+    }
+    
+    constexpr bool operator!=(const Rational& other) const {
+        return !(*this == other);
+    }
+    
+    // Произведения 64-битных чисел точно помещаются в 128 бит, поэтому одно
+    // расширяющее умножение с каждой стороны даёт точный ответ без ветвлений.
+    constexpr std::strong_ordering operator<=>(const Rational& other) const {
+        return static_cast<int128_t>(numerator_) * other.denominator_ <=>
+               static_cast<int128_t>(other.numerator_) * denominator_;
+    }
+
+    constexpr bool operator<(const Rational& other) const {
+        return (*this <=> other) < 0;
+    }
+    
+    constexpr bool operator<=(const Rational& other) const {
+        return (*this <=> other) <= 0;
+    }
+    
+    constexpr bool operator>(const Rational& other) const {
+        return (*this <=> other) > 0;
+    }
+    
+    constexpr bool operator>=(const Rational& other) const {
+        return (*this <=> other) >= 0;
+    }
+
+    // Обратные формы (k == r, k < r и т. д.) C++20 выводит из этих двух операторов.
+    constexpr bool operator==(int64_t k) const {
+        return denominator_ == 1 && numerator_ == k;
+    }
+
+    constexpr std::strong_ordering operator<=>(int64_t k) const {
+        return static_cast<int128_t>(numerator_) <=> static_cast<int128_t>(k) * denominator_;
+    }
+};
+
+// Члены цепной дроби [a0; a1, a2, ...] числа, вычисляемые по одному шагом
+// алгоритма Евклида по полям дроби: a0 = floor(x) может быть отрицательным,
+// остальные положительны. После каждого члена доступна очередная подходящая
+// дробь; её поля не превосходят по модулю полей x, так что все они точны.
+class ContinuedFraction {
+private:
+    int64_t head_;
+    bool started_ = false;
+    // Ещё не разложенный остаток n_ / d_; d_ == 0 — членов больше нет.
+    uint64_t n_;
+    uint64_t d_;
+    int64_t p0_ = 0, q0_ = 1, p1_ = 1, q1_ = 0;
+
+    constexpr void push(int64_t term) {
+        int64_t p2 = static_cast<int64_t>(static_cast<int128_t>(term) * p1_ + p0_);
+        int64_t q2 = static_cast<int64_t>(static_cast<int128_t>(term) * q1_ + q0_);
+        p0_ = p1_;
+        q0_ = q1_;
+        p1_ = p2;
+        q1_ = q2;
+    }
+
+public:
+    constexpr explicit ContinuedFraction(const Rational& value)
+        : head_(value.floor()), n_(value.denominator_) {
+        // x - floor(x) = d_ / n_.
+        uint64_t rest = Rational::abs_value(value.numerator_) % value.denominator_;
+        d_ = value.numerator_ >= 0 || rest == 0 ? rest : value.denominator_ - rest;
+    }
+
+    // Записывает следующий член в term; false, если разложение закончилось.
+    constexpr bool next(int64_t& term) {
+        if (!started_) {
+            started_ = true;
+            term = head_;
+        } else {
+            if (d_ == 0) return false;
+            uint64_t a = n_ / d_, r = n_ % d_;
+            n_ = d_;
+            d_ = r;
+            term = static_cast<int64_t>(a);
+        }
+        push(term);
+        return true;
+    }
+
+    // Подходящая дробь по уже выданным членам (до первого next — 0).
+    constexpr Rational convergent() const {
+        if (q1_ == 0) return Rational();
+        return Rational(p1_, static_cast<uint64_t>(q1_), Rational::Canonical());
+    }
+};
+
+constexpr Rational operator""_r(unsigned long long value) {
+    return Rational(static_cast<int64_t>(value));
+}
+
+#if defined(__cpp_lib_format)
+template <>
+struct std::formatter<Rational> : std::formatter<std::string_view> {
+    template <typename FormatContext>
+    auto format(const Rational& value, FormatContext& ctx) const {
+        char buffer[Rational::max_chars];
+        std::to_chars_result result = value.to_chars(buffer, buffer + Rational::max_chars);
+        return std::formatter<std::string_view>::format(std::string_view(buffer, result.ptr - buffer), ctx);
+    }
+};
+#endif
+
+// Дробь всегда хранится в несократимом виде, поэтому равные значения имеют
+// одинаковые поля и хешируются одинаково.
+template <>
+struct std::hash<Rational> {
+    size_t operator()(const Rational& value) const noexcept {
+        uint64_t h = static_cast<uint64_t>(value.numerator()) * 0x9E3779B97F4A7C15ull;
+        h ^= value.denominator() + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+};
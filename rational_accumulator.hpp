@@ -0,0 +1,124 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <limits>
+
+#include "rational.hpp"
+
+// Накапливает результат в несокращённом виде и сокращает его, только когда
+// очередная операция переполнилась бы, либо при чтении значения.
+class RationalAccumulator {
+private:
+    mutable Rational pending_;
+
+    void normalize() const {
+        pending_.reduce();
+    }
+
+    bool try_add(int64_t num, uint64_t den) {
+        int64_t new_numerator;
+        if (den == pending_.denominator_) {
+            if (checked::add(pending_.numerator_, num, new_numerator)) return false;
+            pending_.numerator_ = new_numerator;
+            return true;
+        }
+
+        int64_t term1, term2;
+        int64_t new_denominator;
+        if (checked::mul(pending_.numerator_, den, term1) ||
+            checked::mul(num, pending_.denominator_, term2) ||
+            checked::add(term1, term2, new_numerator) ||
+            checked::mul(pending_.denominator_, den, new_denominator)) {
+            return false;
+        }
+
+        pending_.numerator_ = new_numerator;
+        pending_.denominator_ = new_denominator;
+        return true;
+    }
+
+    bool try_mul(int64_t num, uint64_t den) {
+        int64_t new_numerator;
+        int64_t new_denominator;
+        if (checked::mul(pending_.numerator_, num, new_numerator) ||
+            checked::mul(pending_.denominator_, den, new_denominator)) {
+            return false;
+        }
+
+        pending_.numerator_ = new_numerator;
+        pending_.denominator_ = new_denominator;
+        return true;
+    }
+
+public:
+    RationalAccumulator() {}
+
+    RationalAccumulator(const Rational& value) : pending_(value) {}
+
+    Rational value() const {
+        normalize();
+        return pending_;
+    }
+
+    int64_t numerator() const {
+        return value().numerator_;
+    }
+
+    uint64_t denominator() const {
+        return value().denominator_;
+    }
+
+    explicit operator double() const {
+        return static_cast<double>(value());
+    }
+
+    std::string str() const {
+        return value().str();
+    }
+
+    RationalAccumulator& operator+=(const Rational& other) {
+        if (try_add(other.numerator_, other.denominator_)) return *this;
+
+        normalize();
+        if (try_add(other.numerator_, other.denominator_)) return *this;
+
+        pending_ = value() + other;
+        return *this;
+    }
+
+    // -INT64_MIN не представим, поэтому такое вычитаемое идёт через 128-битное
+    // вычитание Rational, как и у Rational::operator-=.
+    RationalAccumulator& operator-=(const Rational& other) {
+        if (other.numerator_ != std::numeric_limits<int64_t>::min()) return *this += -other;
+
+        pending_ = value() - other;
+        return *this;
+    }
+
+    RationalAccumulator& operator*=(const Rational& other) {
+        if (try_mul(other.numerator_, other.denominator_)) return *this;
+
+        normalize();
+        if (try_mul(other.numerator_, other.denominator_)) return *this;
+
+        pending_ = value() * other;
+        return *this;
+    }
+
+    bool operator==(const RationalAccumulator& other) const {
+        return value() == other.value();
+    }
+
+    bool operator!=(const RationalAccumulator& other) const {
+        return !(*this == other);
+    }
+
+    bool operator==(const Rational& other) const {
+        return value() == other;
+    }
+
+    bool operator!=(const Rational& other) const {
+        return !(*this == other);
+    }
+};
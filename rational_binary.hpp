@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <span>
+#include <vector>
+#include <system_error>
+
+#include "rational.hpp"
+#include "rational_soa.hpp"
+#include "rational_io.hpp"
+
+// Двоичный формат дроби. Заголовок — varint от (zigzag(numerator) << 1) | flag,
+// где flag означает, что за ним следует varint знаменателя; при flag = 0
+// знаменатель равен 1. Целые от -32 до 31 занимают один байт, дроби с малыми
+// числителем и знаменателем — два. Декодер считает, что записаны сокращённые
+// дроби, и повторно их не сокращает.
+class RationalCodec {
+private:
+    static constexpr uint64_t zigzag(int64_t v) {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    static constexpr int64_t unzigzag(uint64_t v) {
+        return static_cast<int64_t>((v >> 1) ^ (0 - (v & 1)));
+    }
+
+    static uint8_t* write_varint(uint128_t value, uint8_t* out) {
+        while (value >= 0x80) {
+            *out++ = static_cast<uint8_t>(value) | 0x80;
+            value >>= 7;
+        }
+        *out++ = static_cast<uint8_t>(value);
+        return out;
+    }
+
+    // Читает varint длиной до 65 бит: младшие 64 бита в low, 65-й в high.
+    // Возвращает nullptr, если данные обрываются или число длиннее.
+    static const uint8_t* read_varint(const uint8_t* p, const uint8_t* last, uint64_t& low, uint64_t& high) {
+        high = 0;
+        if (p != last && *p < 0x80) {
+            low = *p;
+            return p + 1;
+        }
+
+        low = 0;
+        for (int shift = 0; shift < 63; shift += 7) {
+            if (p == last) return nullptr;
+            uint8_t byte = *p++;
+            low |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) return p;
+        }
+
+        if (p == last || *p > 0x03) return nullptr;
+        low |= static_cast<uint64_t>(*p & 1) << 63;
+        high = *p >> 1;
+        return p + 1;
+    }
+
+    static uint8_t* write_value(int64_t num, uint64_t den, uint8_t* out) {
+        uint128_t header = static_cast<uint128_t>(zigzag(num)) << 1;
+        if (den == 1) return write_varint(header, out);
+
+        out = write_varint(header | 1, out);
+        return write_varint(den, out);
+    }
+
+public:
+    // Наибольшая длина записи одной дроби: 10 байт заголовка и 10 байт знаменателя.
+    static constexpr size_t max_encoded_size = 20;
+
+    // Записывает value в out (не меньше max_encoded_size байт) и возвращает конец записи.
+    static uint8_t* encode(const Rational& value, uint8_t* out) {
+        return write_value(value.numerator_, value.denominator_, out);
+    }
+
+    // Возвращает конец прочитанной записи или nullptr, если запись повреждена.
+    static const uint8_t* decode(const uint8_t* first, const uint8_t* last, Rational& value) {
+        uint64_t header, header_high;
+        const uint8_t* p = read_varint(first, last, header, header_high);
+        if (p == nullptr) return nullptr;
+
+        uint64_t den = 1;
+        if (header & 1) {
+            uint64_t den_high;
+            p = read_varint(p, last, den, den_high);
+            if (p == nullptr || den_high != 0 || den == 0) return nullptr;
+        }
+
+        value.numerator_ = unzigzag((header >> 1) | (header_high << 63));
+        value.denominator_ = den;
+        return p;
+    }
+
+    // Дописывает записи всех values в конец out.
+    static void encode(ConstRationalSpan values, std::vector<uint8_t>& out) {
+        size_t offset = out.size();
+        out.resize(offset + values.size() * max_encoded_size);
+        uint8_t* p = out.data() + offset;
+        for (size_t i = 0; i < values.size(); ++i) {
+            p = write_value(values.numerators[i], values.denominators[i], p);
+        }
+        out.resize(static_cast<size_t>(p - out.data()));
+    }
+
+    // Читает out.size() записей подряд; возвращает конец прочитанного или nullptr.
+    static const uint8_t* decode(const uint8_t* first, const uint8_t* last, RationalSpan out) {
+        const uint8_t* p = first;
+        for (size_t i = 0; i < out.size(); ++i) {
+            Rational value;
+            p = decode(p, last, value);
+            if (p == nullptr) return nullptr;
+            out.numerators[i] = value.numerator_;
+            out.denominators[i] = value.denominator_;
+        }
+        return p;
+    }
+};
+
+// Колоночный файл для RationalSoA: заголовок, затем count числителей и count
+// знаменателей фиксированной ширины в порядке байтов машины. Такой файл можно
+// отобразить в память и работать с ним как с ConstRationalSpan без разбора.
+struct RationalColumnsHeader {
+    char magic[4] = {'R', 'S', 'O', 'A'};
+    uint32_t byte_order = 0x01020304;
+    uint64_t count = 0;
+};
+
+inline std::errc write_rational_columns(const char* path, ConstRationalSpan values) {
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) return static_cast<std::errc>(errno);
+
+    RationalColumnsHeader header;
+    header.count = values.size();
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(values.numerators.data(), sizeof(int64_t), values.size(), file) == values.size() &&
+              std::fwrite(values.denominators.data(), sizeof(uint64_t), values.size(), file) == values.size();
+    ok = std::fclose(file) == 0 && ok;
+    return ok ? std::errc() : std::errc::io_error;
+}
+
+class MappedRationalColumns {
+private:
+    MappedFile file_;
+    ConstRationalSpan values_;
+
+public:
+    std::errc open(const char* path) {
+        values_ = {};
+        std::errc error = file_.open(path);
+        if (error != std::errc()) return error;
+
+        RationalColumnsHeader expected, header;
+        if (file_.size() < sizeof(header)) return std::errc::invalid_argument;
+        std::memcpy(&header, file_.data(), sizeof(header));
+        if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+            header.byte_order != expected.byte_order ||
+            header.count > (file_.size() - sizeof(header)) / (sizeof(int64_t) + sizeof(uint64_t))) {
+            file_.close();
+            return std::errc::invalid_argument;
+        }
+
+        const char* columns = file_.data() + sizeof(header);
+        size_t count = static_cast<size_t>(header.count);
+        values_.numerators = {reinterpret_cast<const int64_t*>(columns), count};
+        values_.denominators = {reinterpret_cast<const uint64_t*>(columns + count * sizeof(int64_t)), count};
+        return std::errc();
+    }
+
+    ConstRationalSpan values() const { return values_; }
+    size_t size() const { return values_.size(); }
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+
+// Счётчики горячих путей Rational. Собираются, только если определён макрос
+// RATIONAL_INSTRUMENT; без него RATIONAL_COUNT ничего не делает, а snapshot()
+// возвращает нули.
+namespace instrument {
+
+struct Counters {
+    uint64_t fast_path = 0;       // сложение или умножение целиком в 64 битах
+    uint64_t add_safe = 0;        // сложение через 128-битный add_safe
+    uint64_t cross_cancel = 0;    // умножение с сокращением крест-накрест
+    uint64_t overflow = 0;        // результат +, - или * не поместился и усечён
+    uint64_t reduce = 0;          // вызовы reduce()
+    uint64_t gcd_iterations = 0;  // итерации цикла в binary_gcd и gcd_wide
+};
+
+} // namespace instrument
+
+#ifdef RATIONAL_INSTRUMENT
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace instrument {
+
+namespace detail {
+
+// Счётчики одного потока, каждый блок на своей кеш-линии. Пишет в них только
+// поток-владелец (relaxed-операции без блокировки шины); snapshot() читает их
+// из любого потока.
+struct alignas(64) Slot {
+    std::atomic<uint64_t> fast_path{0};
+    std::atomic<uint64_t> add_safe{0};
+    std::atomic<uint64_t> cross_cancel{0};
+    std::atomic<uint64_t> overflow{0};
+    std::atomic<uint64_t> reduce{0};
+    std::atomic<uint64_t> gcd_iterations{0};
+};
+
+// Блоки не освобождаются после завершения потока, чтобы его счёт попадал в
+// последующие снимки.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Slot>> slots;
+};
+
+inline Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+inline Slot& local() {
+    thread_local Slot* slot = [] {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.slots.push_back(std::make_unique<Slot>());
+        return r.slots.back().get();
+    }();
+    return *slot;
+}
+
+inline void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+// Сумма счётчиков всех потоков на момент вызова.
+inline Counters snapshot() {
+    detail::Registry& r = detail::registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    Counters total;
+    for (const std::unique_ptr<detail::Slot>& slot : r.slots) {
+        total.fast_path += slot->fast_path.load(std::memory_order_relaxed);
+        total.add_safe += slot->add_safe.load(std::memory_order_relaxed);
+        total.cross_cancel += slot->cross_cancel.load(std::memory_order_relaxed);
+        total.overflow += slot->overflow.load(std::memory_order_relaxed);
+        total.reduce += slot->reduce.load(std::memory_order_relaxed);
+        total.gcd_iterations += slot->gcd_iterations.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// Обнуляет счётчики. Потоки, считающие в этот момент, могут перезаписать
+// сброс своим прежним значением.
+inline void reset() {
+    detail::Registry& r = detail::registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const std::unique_ptr<detail::Slot>& slot : r.slots) {
+        slot->fast_path.store(0, std::memory_order_relaxed);
+        slot->add_safe.store(0, std::memory_order_relaxed);
+        slot->cross_cancel.store(0, std::memory_order_relaxed);
+        slot->overflow.store(0, std::memory_order_relaxed);
+        slot->reduce.store(0, std::memory_order_relaxed);
+        slot->gcd_iterations.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace instrument
+
+// Не считает во время вычисления на этапе компиляции.
+#define RATIONAL_COUNT(name)                                                \
+    do {                                                                    \
+        if (!std::is_constant_evaluated()) {                                \
+            ::instrument::detail::bump(::instrument::detail::local().name); \
+        }                                                                   \
+    } while (0)
+
+#else
+
+namespace instrument {
+
+inline Counters snapshot() { return Counters(); }
+
+inline void reset() {}
+
+} // namespace instrument
+
+#define RATIONAL_COUNT(name) ((void)0)
+
+#endif
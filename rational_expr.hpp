@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "rational.hpp"
+
+// Ленивые выражения над Rational. Включаются явно: fused(a) * b + fused(c) * d - e
+// строит дерево выражения, а не промежуточные дроби. Откладываются только
+// поддеревья с fused(...) в корне: в fused(a) * b + c * d произведение c * d
+// вычисляется сразу обычным operator* и входит в дерево готовой дробью.
+// При приведении к Rational (или вызове value()) дерево вычисляется
+// в несокращённом виде с одним сокращением в конце. Промежуточные числитель и знаменатель держатся в
+// пределах 64 бит: если очередной узел выходит за них, этот узел и все узлы
+// над ним вычисляются обычными операторами из сокращённых значений детей.
+// Поэтому результат всегда совпадает с пошаговым вычислением.
+// Узлы хранят операнды по значению и переживают временные дроби.
+class FusedEvaluator {
+public:
+    struct Wide {
+        int128_t num;
+        uint128_t den;
+    };
+
+    // Результат узла: точное несокращённое значение (exact) или дробь,
+    // полученная обычными операторами. У листа заполнены оба.
+    struct Partial {
+        bool exact = false;
+        bool has_rational = false;
+        Wide wide;
+        Rational rational;
+    };
+
+    // Операнды, которые Rational уже усёк при переполнении, не представимы
+    // (в том числе с обнулившимся при усечении знаменателем).
+    static bool load(const Rational& value, Wide& out) {
+        out = {value.numerator_, value.denominator_};
+        return out.den != 0 && Rational::fits(out.num, out.den);
+    }
+
+    // Несокращённое значение узла остаётся точным, пока помещается в 64 бита.
+    // Иначе сокращать его здесь незачем: узел вычисляется обычным оператором,
+    // который сократит результат сам.
+    static bool settle(Wide& value) {
+        if (value.num == 0) {
+            value.den = 1;
+            return true;
+        }
+        return Rational::fits(value.num, value.den);
+    }
+
+    // Операнды по модулю не больше 2^63, поэтому произведения и их сумма
+    // помещаются в 128 бит.
+    static bool apply(char op, const Wide& a, const Wide& b, Wide& out) {
+        switch (op) {
+        case '+':
+            out = {a.num * static_cast<int128_t>(b.den) + b.num * static_cast<int128_t>(a.den), a.den * b.den};
+            break;
+        case '-':
+            out = {a.num * static_cast<int128_t>(b.den) - b.num * static_cast<int128_t>(a.den), a.den * b.den};
+            break;
+        case '*':
+            out = {a.num * b.num, a.den * b.den};
+            break;
+        default:
+            // Как и у operator/, деление на ноль даёт 0.
+            if (b.num == 0) {
+                out = {0, 1};
+                return true;
+            }
+            out = {a.num * static_cast<int128_t>(b.den) * (b.num < 0 ? -1 : 1),
+                   a.den * static_cast<uint128_t>(b.num < 0 ? -b.num : b.num)};
+            break;
+        }
+        return settle(out);
+    }
+
+    static Rational finish(const Wide& value) {
+        Rational result;
+        Rational::from_wide(value.num, value.den, result);
+        return result;
+    }
+
+    // Значение узла, каким его получило бы пошаговое вычисление.
+    static Rational rational(const Partial& value) {
+        return value.has_rational ? value.rational : finish(value.wide);
+    }
+};
+
+struct FusedNode {};
+
+template <typename T>
+inline constexpr bool is_fused_node = std::is_base_of_v<FusedNode, T>;
+
+class FusedLeaf : public FusedNode {
+private:
+    Rational value_;
+
+public:
+    FusedLeaf(const Rational& value) : value_(value) {}
+
+    void evaluate(FusedEvaluator::Partial& out) const {
+        out.exact = FusedEvaluator::load(value_, out.wide);
+        out.has_rational = true;
+        out.rational = value_;
+    }
+};
+
+template <char Op, typename L, typename R>
+class FusedBinary : public FusedNode {
+private:
+    L lhs_;
+    R rhs_;
+
+public:
+    template <typename A, typename B>
+    FusedBinary(const A& lhs, const B& rhs) : lhs_(lhs), rhs_(rhs) {}
+
+    void evaluate(FusedEvaluator::Partial& out) const {
+        FusedEvaluator::Partial a, b;
+        lhs_.evaluate(a);
+        rhs_.evaluate(b);
+        out.has_rational = false;
+        out.exact = a.exact && b.exact && FusedEvaluator::apply(Op, a.wide, b.wide, out.wide);
+        if (out.exact) return;
+
+        Rational x = FusedEvaluator::rational(a), y = FusedEvaluator::rational(b);
+        out.has_rational = true;
+        if constexpr (Op == '+') out.rational = x + y;
+        else if constexpr (Op == '-') out.rational = x - y;
+        else if constexpr (Op == '*') out.rational = x * y;
+        else out.rational = x / y;
+    }
+
+    Rational value() const {
+        FusedEvaluator::Partial result;
+        evaluate(result);
+        return FusedEvaluator::rational(result);
+    }
+
+    operator Rational() const { return value(); }
+};
+
+inline FusedLeaf fused(const Rational& value) {
+    return FusedLeaf(value);
+}
+
+template <typename T>
+using fused_operand_t = std::conditional_t<is_fused_node<T>, T, FusedLeaf>;
+
+// Хотя бы один операнд должен быть узлом выражения; второй может быть узлом,
+// Rational или целым.
+template <typename L, typename R>
+inline constexpr bool fused_operands = (is_fused_node<L> || is_fused_node<R>) &&
+                                       (is_fused_node<L> || std::is_convertible_v<L, Rational>) &&
+                                       (is_fused_node<R> || std::is_convertible_v<R, Rational>);
+
+template <typename L, typename R>
+    requires fused_operands<L, R>
+FusedBinary<'+', fused_operand_t<L>, fused_operand_t<R>> operator+(const L& lhs, const R& rhs) {
+    return {lhs, rhs};
+}
+
+template <typename L, typename R>
+    requires fused_operands<L, R>
+FusedBinary<'-', fused_operand_t<L>, fused_operand_t<R>> operator-(const L& lhs, const R& rhs) {
+    return {lhs, rhs};
+}
+
+template <typename L, typename R>
+    requires fused_operands<L, R>
+FusedBinary<'*', fused_operand_t<L>, fused_operand_t<R>> operator*(const L& lhs, const R& rhs) {
+    return {lhs, rhs};
+}
+
+template <typename L, typename R>
+    requires fused_operands<L, R>
+FusedBinary<'/', fused_operand_t<L>, fused_operand_t<R>> operator/(const L& lhs, const R& rhs) {
+    return {lhs, rhs};
+}
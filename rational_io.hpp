@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <charconv>
+#include <system_error>
+
+#include "rational.hpp"
+#include "rational_soa.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RATIONAL_HAS_MMAP 1
+#else
+#include <fstream>
+#include <vector>
+#endif
+
+// Файл, отображённый в память только для чтения.
+class MappedFile {
+private:
+#ifdef RATIONAL_HAS_MMAP
+    void* data_ = nullptr;
+#else
+    std::vector<char> buffer_;
+#endif
+    size_t size_ = 0;
+
+public:
+    MappedFile() {}
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { close(); }
+
+    std::errc open(const char* path) {
+        close();
+#ifdef RATIONAL_HAS_MMAP
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return static_cast<std::errc>(errno);
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            std::errc error = static_cast<std::errc>(errno);
+            ::close(fd);
+            return error;
+        }
+
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ != 0) {
+            void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                std::errc error = static_cast<std::errc>(errno);
+                ::close(fd);
+                size_ = 0;
+                return error;
+            }
+            data_ = mapped;
+            madvise(data_, size_, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+#else
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) return std::errc::no_such_file_or_directory;
+        buffer_.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        if (!in.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()))) return std::errc::io_error;
+        size_ = buffer_.size();
+#endif
+        return std::errc();
+    }
+
+    void close() {
+#ifdef RATIONAL_HAS_MMAP
+        if (data_ != nullptr) munmap(data_, size_);
+        data_ = nullptr;
+#else
+        buffer_.clear();
+#endif
+        size_ = 0;
+    }
+
+    const char* data() const {
+#ifdef RATIONAL_HAS_MMAP
+        return static_cast<const char*>(data_);
+#else
+        return buffer_.data();
+#endif
+    }
+
+    size_t size() const { return size_; }
+
+    // Сообщает системе, что первые offset байт больше не понадобятся: при
+    // последовательном чтении прочитанные страницы не копятся в памяти.
+    void discard(size_t offset) {
+#ifdef RATIONAL_HAS_MMAP
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t length = std::min(offset, size_) / page * page;
+        if (data_ != nullptr && length != 0) madvise(data_, length, MADV_DONTNEED);
+#else
+        (void)offset;
+#endif
+    }
+};
+
+// Разбирает не больше limit дробей, записанных по одной на строку, и дописывает
+// их в out, не резервируя память. Возвращает указатель, с которого надо
+// продолжить (last, если текст разобран целиком), или начало некорректной
+// строки вместе с кодом ошибки.
+inline std::from_chars_result parse_rationals(const char* first, const char* last, RationalSoA& out, size_t limit) {
+    const char* p = first;
+    for (size_t count = 0; p != last && count < limit;) {
+        if (*p == '\n' || *p == '\r') {
+            ++p;
+            continue;
+        }
+
+        Rational value;
+        std::from_chars_result parsed = Rational::from_chars(p, last, value);
+        if (parsed.ec != std::errc()) return {p, parsed.ec};
+
+        const char* end = parsed.ptr;
+        if (end != last && *end == '\r') ++end;
+        if (end != last && *end != '\n') return {p, std::errc::invalid_argument};
+
+        out.push_back(value);
+        ++count;
+        p = end;
+    }
+    return {p, std::errc()};
+}
+
+// Разбирает дроби, записанные по одной на строку (допускаются "\r\n" и пустые
+// строки), и дописывает их в out. Останавливается на первой некорректной строке
+// и возвращает указатель на её начало вместе с кодом ошибки.
+inline std::from_chars_result parse_rationals(const char* first, const char* last, RationalSoA& out) {
+    size_t lines = 0;
+    for (const char* p = first; p != last; ++lines) {
+        const void* newline = std::memchr(p, '\n', static_cast<size_t>(last - p));
+        p = newline ? static_cast<const char*>(newline) + 1 : last;
+    }
+    out.reserve(out.size() + lines);
+
+    return parse_rationals(first, last, out, lines);
+}
+
+// Читает файл с дробями по одной на строку, отображая его в память.
+inline std::errc load_rationals(const char* path, RationalSoA& out) {
+    MappedFile file;
+    std::errc error = file.open(path);
+    if (error != std::errc()) return error;
+
+    return parse_rationals(file.data(), file.data() + file.size(), out).ec;
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "rational.hpp"
+
+// Хеш-таблица с открытой адресацией (линейное пробирование) и ключами-дробями.
+// Числители, знаменатели и значения хранятся в трёх отдельных массивах, так
+// что при поиске просматриваются только плотно упакованные знаменатели и
+// числители. Пустая ячейка — знаменатель 0, который у дроби невозможен;
+// удаление сдвигает следующие элементы цепочки назад, без «надгробий».
+// Указатели, возвращаемые find и operator[], действительны до следующей вставки.
+template <typename T>
+class RationalMap {
+private:
+    std::vector<int64_t> numerators_;
+    std::vector<uint64_t> denominators_;
+    std::vector<T> values_;
+    size_t size_ = 0;
+
+    Rational key_at(size_t slot) const {
+        Rational key;
+        key.numerator_ = numerators_[slot];
+        key.denominator_ = denominators_[slot];
+        return key;
+    }
+
+    size_t mask() const { return denominators_.size() - 1; }
+
+    size_t home(const Rational& key) const { return std::hash<Rational>()(key) & mask(); }
+
+    // Ячейка с ключом key или пустая ячейка, куда его следует вставить.
+    size_t probe(const Rational& key) const {
+        size_t slot = home(key);
+        while (denominators_[slot] != 0 &&
+               (denominators_[slot] != key.denominator_ || numerators_[slot] != key.numerator_)) {
+            slot = (slot + 1) & mask();
+        }
+        return slot;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<int64_t> old_numerators;
+        std::vector<uint64_t> old_denominators;
+        std::vector<T> old_values;
+        old_numerators.swap(numerators_);
+        old_denominators.swap(denominators_);
+        old_values.swap(values_);
+        numerators_.assign(capacity, 0);
+        denominators_.assign(capacity, 0);
+        values_.resize(capacity);
+
+        for (size_t i = 0; i < old_denominators.size(); ++i) {
+            if (old_denominators[i] == 0) continue;
+            Rational key;
+            key.numerator_ = old_numerators[i];
+            key.denominator_ = old_denominators[i];
+
+            size_t slot = probe(key);
+            numerators_[slot] = old_numerators[i];
+            denominators_[slot] = old_denominators[i];
+            values_[slot] = std::move(old_values[i]);
+        }
+    }
+
+    // Заполненность не больше 3/4.
+    void grow_for(size_t count) {
+        size_t capacity = denominators_.empty() ? 16 : denominators_.size();
+        while (count * 4 > capacity * 3) capacity *= 2;
+        if (capacity != denominators_.size()) rehash(capacity);
+    }
+
+public:
+    RationalMap() {}
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    void reserve(size_t count) { grow_for(count); }
+
+    void clear() {
+        numerators_.clear();
+        denominators_.clear();
+        values_.clear();
+        size_ = 0;
+    }
+
+    T* find(const Rational& key) {
+        if (size_ == 0) return nullptr;
+        size_t slot = probe(key);
+        return denominators_[slot] != 0 ? &values_[slot] : nullptr;
+    }
+
+    const T* find(const Rational& key) const {
+        if (size_ == 0) return nullptr;
+        size_t slot = probe(key);
+        return denominators_[slot] != 0 ? &values_[slot] : nullptr;
+    }
+
+    bool contains(const Rational& key) const { return find(key) != nullptr; }
+
+    // Возвращает значение по ключу, при отсутствии вставляя T().
+    T& operator[](const Rational& key) {
+        grow_for(size_ + 1);
+        size_t slot = probe(key);
+        if (denominators_[slot] == 0) {
+            numerators_[slot] = key.numerator_;
+            denominators_[slot] = key.denominator_;
+            values_[slot] = T();
+            ++size_;
+        }
+        return values_[slot];
+    }
+
+    // Вставляет пару, если ключа ещё нет; возвращает true, если вставка произошла.
+    bool insert(const Rational& key, T value) {
+        grow_for(size_ + 1);
+        size_t slot = probe(key);
+        if (denominators_[slot] != 0) return false;
+
+        numerators_[slot] = key.numerator_;
+        denominators_[slot] = key.denominator_;
+        values_[slot] = std::move(value);
+        ++size_;
+        return true;
+    }
+
+    bool erase(const Rational& key) {
+        if (size_ == 0) return false;
+        size_t hole = probe(key);
+        if (denominators_[hole] == 0) return false;
+
+        // Элемент из [hole + 1, ...) переносится в дыру, если его домашняя
+        // ячейка не лежит циклически между дырой и его текущим положением.
+        for (size_t slot = (hole + 1) & mask(); denominators_[slot] != 0; slot = (slot + 1) & mask()) {
+            size_t want = home(key_at(slot));
+            if (((slot - want) & mask()) >= ((slot - hole) & mask())) {
+                numerators_[hole] = numerators_[slot];
+                denominators_[hole] = denominators_[slot];
+                values_[hole] = std::move(values_[slot]);
+                hole = slot;
+            }
+        }
+        denominators_[hole] = 0;
+        values_[hole] = T();
+        --size_;
+        return true;
+    }
+
+    // Вызывает fn(key, value) для каждой пары в порядке ячеек.
+    template <typename Fn>
+    void for_each(Fn fn) {
+        for (size_t i = 0; i < denominators_.size(); ++i) {
+            if (denominators_[i] != 0) fn(key_at(i), values_[i]);
+        }
+    }
+
+    template <typename Fn>
+    void for_each(Fn fn) const {
+        for (size_t i = 0; i < denominators_.size(); ++i) {
+            if (denominators_[i] != 0) fn(key_at(i), static_cast<const T&>(values_[i]));
+        }
+    }
+};
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "rational.hpp"
+#include "rational_soa.hpp"
+#include "rational_accumulator.hpp"
+#include "rational_parallel.hpp"
+#include "exact_rational.hpp"
+#include "bigint.hpp"
+
+// Плотная матрица дробей, хранящаяся по строкам в RationalSoA. Умножение и
+// исключение распараллелены по блокам строк (threads = 0 — по числу ядер).
+// Исключение идёт в целых BigInt: каждая строка сначала умножается на НОК
+// знаменателей своих элементов. Rational-версии возвращают false, если точный
+// результат не помещается в Rational.
+class RationalMatrix {
+private:
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    RationalSoA values_;
+
+    static constexpr size_t block_size = 32;
+    // Минимальное число элементов строки на поток при исключении.
+    static constexpr size_t min_part_elements = 4096;
+
+    // acc += a * b; если произведение помещается в 64 бита, оно не сокращается.
+    static void accumulate_product(RationalAccumulator& acc, int64_t an, uint64_t ad, int64_t bn, uint64_t bd) {
+        Rational product;
+        int64_t num, den;
+        if (checked::mul(an, bn, num) || checked::mul(ad, bd, den)) {
+            Rational a, b;
+            a.numerator_ = an;
+            a.denominator_ = ad;
+            b.numerator_ = bn;
+            b.denominator_ = bd;
+            product = a * b;
+        } else {
+            product.numerator_ = num;
+            product.denominator_ = static_cast<uint64_t>(den);
+        }
+        acc += product;
+    }
+
+    // Приводит целую матрицу m (rows x cols, по строкам) к ступенчатому виду
+    // без дробей (алгоритм Бареисса): после каждого шага элементы равны минорам
+    // исходной матрицы и не растут, как при обычном исключении Гаусса, а
+    // деление на предыдущий ведущий элемент всегда нацело.
+    // Ведущие элементы ищутся в первых pivot_cols столбцах; возвращает ранг,
+    // sign меняется при каждой перестановке строк.
+    static size_t bareiss(std::vector<BigInt>& m, size_t rows, size_t cols, size_t pivot_cols, int& sign,
+                          size_t threads) {
+        sign = 1;
+        size_t rank = 0;
+        BigInt previous(1);
+        for (size_t k = 0; k < pivot_cols && rank < rows; ++k) {
+            size_t p = rank;
+            while (p < rows && m[p * cols + k].is_zero()) ++p;
+            if (p == rows) continue;
+            if (p != rank) {
+                std::swap_ranges(m.begin() + p * cols, m.begin() + (p + 1) * cols, m.begin() + rank * cols);
+                sign = -sign;
+            }
+
+            const BigInt* top = &m[rank * cols];
+            const BigInt& pivot = top[k];
+            bool divide = previous != BigInt(1);
+            size_t below = rows - rank - 1;
+            parallel_for_parts(below, threads, std::max<size_t>(1, min_part_elements / cols),
+                               [&](size_t, size_t begin, size_t end) {
+                for (size_t i = rank + 1 + begin; i < rank + 1 + end; ++i) {
+                    BigInt* row = &m[i * cols];
+                    bool zero = row[k].is_zero();
+                    for (size_t j = k + 1; j < cols; ++j) {
+                        BigInt value = zero ? pivot * row[j] : pivot * row[j] - row[k] * top[j];
+                        row[j] = divide ? value / previous : std::move(value);
+                    }
+                    row[k] = BigInt();
+                }
+            });
+            previous = pivot;
+            ++rank;
+        }
+        return rank;
+    }
+
+    static BigInt lcm(const BigInt& a, const BigInt& b) {
+        return a / BigInt::gcd(a, b) * b;
+    }
+
+    // НОК start и знаменателей строки. Умножение строки на него делает её
+    // целой, и тогда все миноры в алгоритме Бареисса — целые числа. Пока НОК
+    // помещается в 64 бита, он считается без BigInt.
+    static BigInt row_scale(ConstRationalSpan row, BigInt start = BigInt(1)) {
+        uint64_t scale = 1;
+        for (size_t j = 0; j < row.size(); ++j) {
+            uint64_t factor = row.denominators[j] / binary_gcd(scale, row.denominators[j]);
+            uint64_t next;
+            if (!checked::mul(scale, factor, next)) {
+                scale = next;
+                continue;
+            }
+            start = lcm(start, BigInt::from_unsigned(scale));
+            scale = row.denominators[j];
+        }
+        return scale == 1 ? start : lcm(start, BigInt::from_unsigned(scale));
+    }
+
+    // Дописывает к m строку row, умноженную на scale (кратное её знаменателей).
+    static void append_scaled(std::vector<BigInt>& m, ConstRationalSpan row, const BigInt& scale) {
+        for (size_t j = 0; j < row.size(); ++j) {
+            if (row.numerators[j] == 0) {
+                m.emplace_back();
+            } else {
+                m.push_back(BigInt(row.numerators[j]) * (scale / BigInt::from_unsigned(row.denominators[j])));
+            }
+        }
+    }
+
+public:
+    RationalMatrix() {}
+
+    RationalMatrix(size_t rows, size_t cols) : rows_(rows), cols_(cols), values_(rows * cols) {}
+
+    static RationalMatrix identity(size_t n) {
+        RationalMatrix result(n, n);
+        for (size_t i = 0; i < n; ++i) result.set(i, i, Rational(1));
+        return result;
+    }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+
+    Rational operator()(size_t i, size_t j) const { return values_[i * cols_ + j]; }
+
+    void set(size_t i, size_t j, const Rational& value) { values_.set(i * cols_ + j, value); }
+
+    ConstRationalSpan row(size_t i) const {
+        ConstRationalSpan all = values_;
+        return {all.numerators.subspan(i * cols_, cols_), all.denominators.subspan(i * cols_, cols_)};
+    }
+
+    operator ConstRationalSpan() const { return values_; }
+
+    // Скалярное произведение с отложенным сокращением: произведения и частичные
+    // суммы сокращаются, только когда следующая операция переполнилась бы.
+    static Rational dot(ConstRationalSpan a, ConstRationalSpan b) {
+        RationalAccumulator acc;
+        for (size_t i = 0; i < a.size(); ++i) {
+            accumulate_product(acc, a.numerators[i], a.denominators[i], b.numerators[i], b.denominators[i]);
+        }
+        return acc.value();
+    }
+
+    // out = a * b блоками block_size x block_size; каждая клетка результата
+    // накапливается в RationalAccumulator. Возвращает false, если размеры не
+    // согласованы. out не должен совпадать с a или b.
+    static bool multiply(const RationalMatrix& a, const RationalMatrix& b, RationalMatrix& out, size_t threads = 0) {
+        if (a.cols_ != b.rows_) return false;
+        out = RationalMatrix(a.rows_, b.cols_);
+
+        ConstRationalSpan av = a.values_, bv = b.values_;
+        RationalSpan cv = out.values_;
+        size_t n = a.rows_, m = b.cols_, inner = a.cols_;
+        size_t row_blocks = (n + block_size - 1) / block_size;
+
+        parallel_for_parts(row_blocks, threads, 1, [&](size_t, size_t first_block, size_t last_block) {
+            std::vector<RationalAccumulator> tile(block_size * block_size);
+            for (size_t i0 = first_block * block_size; i0 < std::min(n, last_block * block_size); i0 += block_size) {
+                size_t i1 = std::min(n, i0 + block_size);
+                for (size_t j0 = 0; j0 < m; j0 += block_size) {
+                    size_t j1 = std::min(m, j0 + block_size);
+                    std::fill(tile.begin(), tile.end(), RationalAccumulator());
+
+                    for (size_t k0 = 0; k0 < inner; k0 += block_size) {
+                        size_t k1 = std::min(inner, k0 + block_size);
+                        for (size_t i = i0; i < i1; ++i) {
+                            RationalAccumulator* acc = &tile[(i - i0) * block_size];
+                            for (size_t k = k0; k < k1; ++k) {
+                                int64_t an = av.numerators[i * inner + k];
+                                uint64_t ad = av.denominators[i * inner + k];
+                                if (an == 0) continue;
+                                for (size_t j = j0; j < j1; ++j) {
+                                    accumulate_product(acc[j - j0], an, ad,
+                                                       bv.numerators[k * m + j], bv.denominators[k * m + j]);
+                                }
+                            }
+                        }
+                    }
+
+                    for (size_t i = i0; i < i1; ++i) {
+                        for (size_t j = j0; j < j1; ++j) {
+                            Rational value = tile[(i - i0) * block_size + (j - j0)].value();
+                            cv.numerators[i * m + j] = value.numerator_;
+                            cv.denominators[i * m + j] = value.denominator_;
+                        }
+                    }
+                }
+            }
+        });
+        return true;
+    }
+
+    // При несогласованных размерах возвращает пустую матрицу.
+    RationalMatrix operator*(const RationalMatrix& other) const {
+        RationalMatrix result;
+        multiply(*this, other, result);
+        return result;
+    }
+
+    // Точный определитель квадратной матрицы (для неквадратной — 0).
+    ExactRational determinant_exact(size_t threads = 0) const {
+        if (rows_ != cols_) return ExactRational(0);
+        if (rows_ == 0) return ExactRational(1);
+
+        std::vector<BigInt> m;
+        m.reserve(rows_ * cols_);
+        BigInt scales(1);
+        for (size_t i = 0; i < rows_; ++i) {
+            BigInt scale = row_scale(row(i));
+            append_scaled(m, row(i), scale);
+            scales = scales * scale;
+        }
+
+        int sign;
+        if (bareiss(m, rows_, cols_, cols_, sign, threads) < rows_) return ExactRational(0);
+        BigInt& last = m[rows_ * cols_ - 1];
+        return ExactRational::from_big(sign < 0 ? -last : std::move(last), std::move(scales), {});
+    }
+
+    // Определитель квадратной матрицы. Возвращает false, если матрица не
+    // квадратная или определитель не помещается в Rational.
+    bool determinant(Rational& out, size_t threads = 0) const {
+        return rows_ == cols_ && determinant_exact(threads).to_rational(out);
+    }
+
+    // Точно решает A x = b для квадратной A и b из одного или нескольких
+    // столбцов; x — решение по строкам, n x b.cols() значений. Возвращает
+    // false, если размеры не согласованы или A вырождена.
+    bool solve_exact(const RationalMatrix& b, std::vector<ExactRational>& x, size_t threads = 0) const {
+        if (rows_ != cols_ || b.rows_ != rows_) return false;
+        size_t n = rows_, width = cols_ + b.cols_;
+
+        std::vector<BigInt> m;
+        m.reserve(n * width);
+        for (size_t i = 0; i < n; ++i) {
+            BigInt scale = row_scale(b.row(i), row_scale(row(i)));
+            append_scaled(m, row(i), scale);
+            append_scaled(m, b.row(i), scale);
+        }
+
+        int sign;
+        if (bareiss(m, n, width, n, sign, threads) < n) return false;
+
+        // После исключения U x = c с верхнетреугольной целой U, и det = U[n-1][n-1]
+        // с точностью до знака. По правилу Крамера y = det * x целое, поэтому
+        // обратная подстановка для y делится нацело. Найденные y[j] записываются
+        // на место правой части строки j.
+        const BigInt det = m[(n - 1) * width + n - 1];
+        parallel_for_parts(b.cols_, threads, 1, [&](size_t, size_t begin, size_t end) {
+            for (size_t c = n + begin; c < n + end; ++c) {
+                for (size_t i = n; i-- > 0;) {
+                    BigInt value = det * m[i * width + c];
+                    for (size_t j = i + 1; j < n; ++j) {
+                        if (!m[i * width + j].is_zero()) value = value - m[i * width + j] * m[j * width + c];
+                    }
+                    m[i * width + c] = value / m[i * width + i];
+                }
+            }
+        });
+
+        std::vector<ExactRational> result;
+        result.reserve(n * b.cols_);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t c = n; c < width; ++c) result.push_back(ExactRational::from_big(m[i * width + c], det, {}));
+        }
+        x = std::move(result);
+        return true;
+    }
+
+    // Как solve_exact, но возвращает false и тогда, когда решение не
+    // помещается в Rational.
+    bool solve(const RationalMatrix& b, RationalMatrix& x, size_t threads = 0) const {
+        std::vector<ExactRational> exact;
+        if (!solve_exact(b, exact, threads)) return false;
+
+        RationalMatrix result(rows_, b.cols_);
+        for (size_t i = 0; i < rows_; ++i) {
+            for (size_t c = 0; c < b.cols_; ++c) {
+                Rational value;
+                if (!exact[i * b.cols_ + c].to_rational(value)) return false;
+                result.set(i, c, value);
+            }
+        }
+        x = std::move(result);
+        return true;
+    }
+};
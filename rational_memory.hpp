@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// Ресурсы памяти для BigInt, ExactRational и RationalSoA (их конструкторы с
+// allocator_type принимают и указатель на std::pmr::memory_resource).
+
+// Пул потока для небольших блоков (разряды BigInt, дроби ExactRational).
+// Освобождённые блоки остаются в пуле и переиспользуются, поэтому после
+// прогрева повторяющиеся вычисления не обращаются к глобальной куче. Пул без
+// блокировок: объекты, память которых взята из него, должны создаваться и
+// уничтожаться в одном потоке.
+inline std::pmr::memory_resource* limb_pool() {
+    thread_local std::pmr::unsynchronized_pool_resource pool(std::pmr::pool_options{0, 4096});
+    return &pool;
+}
+
+// Монотонная арена на время одного запроса: выделение — сдвиг указателя,
+// освобождение отдельных блоков ничего не делает, а reset() за O(1)
+// освобождает всё сразу. Если запросу не хватило буфера, недостающая память
+// берётся из кучи, а при reset() буфер увеличивается на столько же, так что
+// следующие запросы того же размера в кучу уже не ходят.
+// Все объекты, размещённые в арене, должны быть уничтожены до reset().
+class RationalArena : public std::pmr::memory_resource {
+private:
+    // Считает память, которую арене пришлось взять сверх буфера.
+    class Upstream : public std::pmr::memory_resource {
+    public:
+        size_t allocated = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            allocated += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    Upstream upstream_;
+    size_t capacity_;
+    std::unique_ptr<std::byte[]> buffer_;
+    std::optional<std::pmr::monotonic_buffer_resource> arena_;
+
+    void start() {
+        arena_.emplace(buffer_.get(), capacity_, &upstream_);
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        return arena_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit RationalArena(size_t capacity = 64 * 1024)
+        : capacity_(std::max<size_t>(capacity, 64)), buffer_(std::make_unique_for_overwrite<std::byte[]>(capacity_)) {
+        start();
+    }
+
+    RationalArena(const RationalArena&) = delete;
+    RationalArena& operator=(const RationalArena&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    void reset() {
+        arena_.reset();
+        if (upstream_.allocated > 0) {
+            capacity_ += upstream_.allocated;
+            upstream_.allocated = 0;
+            buffer_ = std::make_unique_for_overwrite<std::byte[]>(capacity_);
+        }
+        start();
+    }
+};
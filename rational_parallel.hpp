@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Параллельные алгоритмы над диапазонами дробей (Rational, ExactRational,
+// PackedRational). Диапазон делится на равные части по числу потоков
+// (threads = 0 — по числу ядер); каждая часть обрабатывается в своём потоке,
+// результаты частей объединяются попарно.
+
+inline size_t parallel_threads(size_t threads) {
+    return threads != 0 ? threads : std::max<unsigned>(1, std::thread::hardware_concurrency());
+}
+
+// Вызывает fn(part, begin, end) для каждой из частей [0, count) в отдельном потоке.
+// Части не короче min_part; возвращает их число (не больше parallel_threads(threads)).
+template <typename Fn>
+inline size_t parallel_for_parts(size_t count, size_t threads, size_t min_part, Fn fn) {
+    size_t parts = std::max<size_t>(1, std::min(parallel_threads(threads), count / std::max<size_t>(1, min_part)));
+
+    std::vector<std::thread> workers;
+    workers.reserve(parts - 1);
+    for (size_t part = 1; part < parts; ++part) {
+        workers.emplace_back(fn, part, count * part / parts, count * (part + 1) / parts);
+    }
+    fn(size_t(0), size_t(0), count / parts);
+    for (std::thread& worker : workers) worker.join();
+    return parts;
+}
+
+// Попарное (древовидное) сведение: соседние значения и частичные результаты
+// имеют близкие размеры, поэтому знаменатели растут медленнее, чем при
+// последовательном сложении слева направо.
+template <typename It, typename Op>
+inline std::iter_value_t<It> pairwise_reduce(It first, It last, std::iter_value_t<It> identity, Op op) {
+    auto count = std::distance(first, last);
+    if (count == 0) return identity;
+    if (count == 1) return *first;
+
+    It middle = std::next(first, count / 2);
+    return op(pairwise_reduce(first, middle, identity, op), pairwise_reduce(middle, last, identity, op));
+}
+
+template <typename It, typename Op>
+inline std::iter_value_t<It> parallel_reduce(It first, It last, std::iter_value_t<It> identity, Op op,
+                                              size_t threads = 0) {
+    using T = std::iter_value_t<It>;
+    size_t count = static_cast<size_t>(std::distance(first, last));
+    std::vector<T> partials(parallel_threads(threads));
+    size_t parts = parallel_for_parts(count, threads, 4096, [&](size_t part, size_t begin, size_t end) {
+        partials[part] = pairwise_reduce(std::next(first, begin), std::next(first, end), identity, op);
+    });
+    return pairwise_reduce(partials.begin(), partials.begin() + parts, identity, op);
+}
+
+template <typename It>
+inline std::iter_value_t<It> parallel_sum(It first, It last, size_t threads = 0) {
+    using T = std::iter_value_t<It>;
+    return parallel_reduce(first, last, T(0), [](const T& a, const T& b) { return a + b; }, threads);
+}
+
+template <typename It>
+inline std::iter_value_t<It> parallel_product(It first, It last, size_t threads = 0) {
+    using T = std::iter_value_t<It>;
+    return parallel_reduce(first, last, T(1), [](const T& a, const T& b) { return a * b; }, threads);
+}
+
+// Как std::min_element: при равенстве возвращается самый левый элемент.
+template <typename It>
+inline It parallel_min_element(It first, It last, size_t threads = 0) {
+    size_t count = static_cast<size_t>(std::distance(first, last));
+    std::vector<It> best(parallel_threads(threads), last);
+    size_t parts = parallel_for_parts(count, threads, 4096, [&](size_t part, size_t begin, size_t end) {
+        best[part] = std::min_element(std::next(first, begin), std::next(first, end));
+    });
+
+    It result = last;
+    for (size_t part = 0; part < parts; ++part) {
+        if (best[part] != last && (result == last || *best[part] < *result)) result = best[part];
+    }
+    return result;
+}
+
+template <typename It>
+inline It parallel_max_element(It first, It last, size_t threads = 0) {
+    size_t count = static_cast<size_t>(std::distance(first, last));
+    std::vector<It> best(parallel_threads(threads), last);
+    size_t parts = parallel_for_parts(count, threads, 4096, [&](size_t part, size_t begin, size_t end) {
+        best[part] = std::max_element(std::next(first, begin), std::next(first, end));
+    });
+
+    It result = last;
+    for (size_t part = 0; part < parts; ++part) {
+        if (best[part] != last && (result == last || *result < *best[part])) result = best[part];
+    }
+    return result;
+}
+
+// Сортирует по возрастанию. Для каждого элемента заранее вычисляется double;
+// если приближения различаются сильнее погрешности преобразования, порядок
+// определяется ими, иначе — точным сравнением дробей.
+template <typename It>
+inline void parallel_sort(It first, It last, size_t threads = 0) {
+    using T = std::iter_value_t<It>;
+    struct Keyed {
+        double key;
+        T value;
+    };
+
+    size_t count = static_cast<size_t>(std::distance(first, last));
+    std::vector<Keyed> items(count);
+    parallel_for_parts(count, threads, 4096, [&](size_t, size_t begin, size_t end) {
+        It it = std::next(first, begin);
+        for (size_t i = begin; i < end; ++i, ++it) {
+            items[i].key = static_cast<double>(*it);
+            items[i].value = std::move(*it);
+        }
+    });
+
+    auto less = [](const Keyed& a, const Keyed& b) {
+        double bound = (std::fabs(a.key) + std::fabs(b.key)) * 0x1p-48;
+        if (a.key < b.key - bound) return true;
+        if (a.key > b.key + bound) return false;
+        return a.value < b.value;
+    };
+
+    std::vector<size_t> bounds;
+    size_t parts = parallel_for_parts(count, threads, 4096, [&](size_t, size_t begin, size_t end) {
+        std::sort(items.begin() + begin, items.begin() + end, less);
+    });
+    for (size_t part = 0; part <= parts; ++part) bounds.push_back(count * part / parts);
+
+    for (size_t width = 1; width < parts; width *= 2) {
+        size_t merges = (parts + 2 * width - 1) / (2 * width);
+        parallel_for_parts(merges, merges, 1, [&](size_t, size_t begin, size_t end) {
+            for (size_t m = begin; m < end; ++m) {
+                size_t lo = m * 2 * width;
+                size_t mid = std::min(lo + width, parts);
+                size_t hi = std::min(lo + 2 * width, parts);
+                std::inplace_merge(items.begin() + bounds[lo], items.begin() + bounds[mid],
+                                   items.begin() + bounds[hi], less);
+            }
+        });
+    }
+
+    parallel_for_parts(count, threads, 4096, [&](size_t, size_t begin, size_t end) {
+        It it = std::next(first, begin);
+        for (size_t i = begin; i < end; ++i, ++it) *it = std::move(items[i].value);
+    });
+}
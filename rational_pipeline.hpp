@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "rational.hpp"
+#include "rational_soa.hpp"
+#include "rational_io.hpp"
+
+// Ограниченная очередь между одним производителем и одним потребителем.
+// push ждёт свободного места, pop — элемента (через std::atomic::wait, без
+// активного ожидания).
+template <typename T>
+class SpscQueue {
+private:
+    std::vector<T> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+
+public:
+    explicit SpscQueue(size_t capacity)
+        : slots_(std::bit_ceil(std::max<size_t>(capacity, 1))), mask_(slots_.size() - 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    void push(T value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        for (size_t head; tail - (head = head_.load(std::memory_order_acquire)) == slots_.size();) {
+            head_.wait(head, std::memory_order_acquire);
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        tail_.notify_one();
+    }
+
+    T pop() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        for (size_t tail; (tail = tail_.load(std::memory_order_acquire)) == head;) {
+            tail_.wait(tail, std::memory_order_acquire);
+        }
+        T value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        head_.notify_one();
+        return value;
+    }
+};
+
+// Число дробей в порции конвейера: порция вместе с её записью в тексте
+// занимает половину кеша L2 (если его размер неизвестен, считается 256 КиБ).
+inline size_t pipeline_chunk_values() {
+    size_t l2 = 256 * 1024;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    long detected = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (detected > 0) l2 = static_cast<size_t>(detected);
+#endif
+    return std::max<size_t>(256, l2 / 2 / (sizeof(int64_t) + sizeof(uint64_t) + Rational::max_chars + 1));
+}
+
+struct PipelineChunk {
+    RationalSoA values;
+    std::from_chars_result status{nullptr, std::errc()};
+    bool last = false;
+};
+
+namespace pipeline_detail {
+
+// Порций в обороте: по одной на каждую стадию и одна в запасе, поэтому память
+// конвейера не зависит от длины входа.
+inline constexpr size_t chunks_in_flight = 4;
+inline constexpr size_t text_buffer_size = 64 * 1024;
+
+template <typename Transform, typename Reduce, typename Sink, typename Consumed>
+std::from_chars_result run(const char* first, const char* last, Transform& transform, Reduce& reduce, Sink& sink,
+                           size_t chunk_values, Consumed consumed) {
+    if (chunk_values == 0) chunk_values = pipeline_chunk_values();
+
+    std::vector<PipelineChunk> chunks(chunks_in_flight);
+    SpscQueue<PipelineChunk*> empty(chunks_in_flight), parsed(chunks_in_flight), computed(chunks_in_flight);
+    for (PipelineChunk& chunk : chunks) {
+        chunk.values.reserve(chunk_values);
+        empty.push(&chunk);
+    }
+
+    std::thread parser([&] {
+        const char* p = first;
+        for (bool last_chunk = false; !last_chunk;) {
+            PipelineChunk* chunk = empty.pop();
+            chunk->values.clear();
+            chunk->status = parse_rationals(p, last, chunk->values, chunk_values);
+            p = chunk->status.ptr;
+            last_chunk = chunk->last = chunk->status.ec != std::errc() || p == last;
+            parsed.push(chunk);
+            consumed(p);
+        }
+    });
+
+    std::thread compute([&] {
+        for (bool last_chunk = false; !last_chunk;) {
+            PipelineChunk* chunk = parsed.pop();
+            transform(static_cast<RationalSpan>(chunk->values));
+            last_chunk = chunk->last;
+            computed.push(chunk);
+        }
+    });
+
+    std::vector<char> text(text_buffer_size);
+    size_t used = 0;
+    std::from_chars_result status;
+    for (bool last_chunk = false; !last_chunk;) {
+        PipelineChunk* chunk = computed.pop();
+        reduce(static_cast<ConstRationalSpan>(chunk->values));
+        for (size_t i = 0; i < chunk->values.size(); ++i) {
+            if (text.size() - used < Rational::max_chars + 1) {
+                sink(static_cast<const char*>(text.data()), used);
+                used = 0;
+            }
+            char* end = chunk->values[i].to_chars(text.data() + used, text.data() + text.size()).ptr;
+            *end++ = '\n';
+            used = static_cast<size_t>(end - text.data());
+        }
+        status = chunk->status;
+        last_chunk = chunk->last;
+        empty.push(chunk);
+    }
+    if (used != 0) sink(static_cast<const char*>(text.data()), used);
+
+    parser.join();
+    compute.join();
+    return status;
+}
+
+} // namespace pipeline_detail
+
+// Потоковая обработка дробей, записанных по одной на строку: разбор ->
+// transform -> reduce -> вывод, ни одна стадия не держит вход целиком.
+// Текст делится на порции по chunk_values дробей (0 — по размеру кеша L2).
+// Разбор и transform идут каждый в своём потоке, reduce и вывод — в вызывающем;
+// стадии связаны очередями SpscQueue и работают одновременно над соседними
+// порциями. Каждая стадия получает порции по порядку.
+//   transform(RationalSpan) — изменяет значения порции на месте (например,
+//     пакетными операциями RationalSoA);
+//   reduce(ConstRationalSpan) — накапливает итог по порции;
+//   sink(const char* data, size_t size) — получает строки результата.
+// Как и parse_rationals, останавливается на первой некорректной строке, успев
+// обработать все дроби до неё, и возвращает её начало с кодом ошибки.
+template <typename Transform, typename Reduce, typename Sink>
+std::from_chars_result stream_rationals(const char* first, const char* last, Transform transform, Reduce reduce,
+                                        Sink sink, size_t chunk_values = 0) {
+    return pipeline_detail::run(first, last, transform, reduce, sink, chunk_values, [](const char*) {});
+}
+
+// То же для файла, отображённого в память; прочитанные страницы сразу
+// возвращаются системе.
+template <typename Transform, typename Reduce, typename Sink>
+std::errc stream_rationals(const char* path, Transform transform, Reduce reduce, Sink sink, size_t chunk_values = 0) {
+    MappedFile file;
+    std::errc error = file.open(path);
+    if (error != std::errc()) return error;
+
+    const char* first = file.data();
+    return pipeline_detail::run(first, first + file.size(), transform, reduce, sink, chunk_values,
+                                [&](const char* p) { file.discard(static_cast<size_t>(p - first)); }).ec;
+}
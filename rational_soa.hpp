@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "rational.hpp"
+
+struct ConstRationalSpan {
+    std::span<const int64_t> numerators;
+    std::span<const uint64_t> denominators;
+
+    size_t size() const { return numerators.size(); }
+};
+
+struct RationalSpan {
+    std::span<int64_t> numerators;
+    std::span<uint64_t> denominators;
+
+    size_t size() const { return numerators.size(); }
+
+    operator ConstRationalSpan() const { return {numerators, denominators}; }
+};
+
+// Массив дробей в виде двух отдельных массивов (structure of arrays).
+// Пакетные операции сначала считают быстрый путь целым блоком в векторизуемом
+// цикле, а затем сокращают результат; элементы, которые могли бы переполниться,
+// обрабатываются обычными скалярными операторами Rational.
+// Все диапазоны в одном вызове должны иметь одинаковую длину; out может
+// совпадать с одним из входов. Массивы лежат в ресурсе allocator; копия
+// остаётся в ресурсе оригинала.
+class RationalSoA {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+private:
+    std::pmr::vector<int64_t> numerators_;
+    std::pmr::vector<uint64_t> denominators_;
+
+    static constexpr size_t block_size = 256;
+    static constexpr int fast_bits = 31;
+
+    static uint64_t magnitude(int64_t v) {
+        uint64_t sign = static_cast<uint64_t>(v >> 63);
+        return (static_cast<uint64_t>(v) ^ sign) - sign;
+    }
+
+    static Rational load(ConstRationalSpan values, size_t i) {
+        Rational result;
+        result.numerator_ = values.numerators[i];
+        result.denominator_ = values.denominators[i];
+        return result;
+    }
+
+    static void store(RationalSpan values, size_t i, const Rational& value) {
+        values.numerators[i] = value.numerator_;
+        values.denominators[i] = value.denominator_;
+    }
+
+    static void store_reduced(RationalSpan values, size_t i, int64_t num, uint64_t den) {
+        Rational result;
+        result.numerator_ = num;
+        result.denominator_ = den;
+        result.reduce();
+        store(values, i, result);
+    }
+
+public:
+    RationalSoA() {}
+
+    explicit RationalSoA(const allocator_type& allocator) : numerators_(allocator), denominators_(allocator) {}
+
+    explicit RationalSoA(size_t count, const allocator_type& allocator = {})
+        : numerators_(count, 0, allocator), denominators_(count, 1, allocator) {}
+
+    RationalSoA(const RationalSoA& other) : RationalSoA(other, other.get_allocator()) {}
+
+    RationalSoA(const RationalSoA& other, const allocator_type& allocator)
+        : numerators_(other.numerators_, allocator), denominators_(other.denominators_, allocator) {}
+
+    RationalSoA(RationalSoA&& other) = default;
+
+    // Присваивание оставляет массивы в прежнем ресурсе.
+    RationalSoA& operator=(const RationalSoA& other) = default;
+    RationalSoA& operator=(RationalSoA&& other) = default;
+
+    allocator_type get_allocator() const { return numerators_.get_allocator(); }
+
+    size_t size() const { return numerators_.size(); }
+
+    void reserve(size_t count) {
+        numerators_.reserve(count);
+        denominators_.reserve(count);
+    }
+
+    void resize(size_t count) {
+        numerators_.resize(count, 0);
+        denominators_.resize(count, 1);
+    }
+
+    void clear() {
+        numerators_.clear();
+        denominators_.clear();
+    }
+
+    void push_back(const Rational& value) {
+        numerators_.push_back(value.numerator_);
+        denominators_.push_back(value.denominator_);
+    }
+
+    Rational operator[](size_t i) const { return load(*this, i); }
+
+    void set(size_t i, const Rational& value) { store(*this, i, value); }
+
+    std::span<const int64_t> numerators() const { return numerators_; }
+    std::span<const uint64_t> denominators() const { return denominators_; }
+
+    operator ConstRationalSpan() const { return {numerators_, denominators_}; }
+    operator RationalSpan() { return {numerators_, denominators_}; }
+
+    static void add(ConstRationalSpan a, ConstRationalSpan b, RationalSpan out) {
+        int64_t raw_num[block_size];
+        uint64_t raw_den[block_size];
+        bool fits[block_size];
+
+        for (size_t start = 0; start < out.size(); start += block_size) {
+            size_t count = std::min(block_size, out.size() - start);
+            const int64_t* an = a.numerators.data() + start;
+            const uint64_t* ad = a.denominators.data() + start;
+            const int64_t* bn = b.numerators.data() + start;
+            const uint64_t* bd = b.denominators.data() + start;
+
+            // Если все четыре числа меньше 2^31, произведения и сумма помещаются в int64_t.
+            for (size_t i = 0; i < count; ++i) {
+                uint64_t bits = magnitude(an[i]) | magnitude(bn[i]) | ad[i] | bd[i];
+                fits[i] = (bits >> fast_bits) == 0;
+                raw_num[i] = static_cast<int64_t>(static_cast<uint64_t>(an[i]) * bd[i] +
+                                                  static_cast<uint64_t>(bn[i]) * ad[i]);
+                raw_den[i] = ad[i] * bd[i];
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                if (fits[i]) {
+                    store_reduced(out, start + i, raw_num[i], raw_den[i]);
+                } else {
+                    store(out, start + i, load(a, start + i) + load(b, start + i));
+                }
+            }
+        }
+    }
+
+    static void mul(ConstRationalSpan a, ConstRationalSpan b, RationalSpan out) {
+        int64_t raw_num[block_size];
+        uint64_t raw_den[block_size];
+        bool fits[block_size];
+
+        for (size_t start = 0; start < out.size(); start += block_size) {
+            size_t count = std::min(block_size, out.size() - start);
+            const int64_t* an = a.numerators.data() + start;
+            const uint64_t* ad = a.denominators.data() + start;
+            const int64_t* bn = b.numerators.data() + start;
+            const uint64_t* bd = b.denominators.data() + start;
+
+            for (size_t i = 0; i < count; ++i) {
+                uint64_t bits = magnitude(an[i]) | magnitude(bn[i]) | ad[i] | bd[i];
+                fits[i] = (bits >> fast_bits) == 0;
+                raw_num[i] = static_cast<int64_t>(static_cast<uint64_t>(an[i]) * static_cast<uint64_t>(bn[i]));
+                raw_den[i] = ad[i] * bd[i];
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                if (fits[i]) {
+                    store_reduced(out, start + i, raw_num[i], raw_den[i]);
+                } else {
+                    store(out, start + i, load(a, start + i) * load(b, start + i));
+                }
+            }
+        }
+    }
+
+    // out[i] = -1, 0 или 1 в зависимости от знака a[i] - b[i].
+    static void compare(ConstRationalSpan a, ConstRationalSpan b, std::span<int8_t> out) {
+        const int64_t* an = a.numerators.data();
+        const uint64_t* ad = a.denominators.data();
+        const int64_t* bn = b.numerators.data();
+        const uint64_t* bd = b.denominators.data();
+
+        for (size_t i = 0; i < out.size(); ++i) {
+            int64_t lhs = static_cast<int64_t>(static_cast<uint64_t>(an[i]) * bd[i]);
+            int64_t rhs = static_cast<int64_t>(static_cast<uint64_t>(bn[i]) * ad[i]);
+            out[i] = static_cast<int8_t>((lhs > rhs) - (lhs < rhs));
+        }
+
+        for (size_t i = 0; i < out.size(); ++i) {
+            uint64_t bits = magnitude(an[i]) | magnitude(bn[i]) | ad[i] | bd[i];
+            if ((bits >> fast_bits) != 0) {
+                Rational lhs = load(a, i), rhs = load(b, i);
+                out[i] = static_cast<int8_t>((rhs < lhs) - (lhs < rhs));
+            }
+        }
+    }
+
+    static void to_double(ConstRationalSpan values, std::span<double> out) {
+        const int64_t* num = values.numerators.data();
+        const uint64_t* den = values.denominators.data();
+
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = static_cast<double>(num[i]) / static_cast<double>(den[i]);
+        }
+    }
+};
@@ -0,0 +1,112 @@
+// Проверяет, что после прогрева повторяющиеся запросы над RationalArena и
+// limb_pool() не обращаются к глобальной куче: считаются все формы operator new,
+// в том числе выравнивающая, через которую идёт new_delete_resource.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+#include <random>
+
+#include "rational_memory.hpp"
+#include "exact_rational.hpp"
+#include "rational_soa.hpp"
+
+namespace {
+
+size_t global_allocations = 0;
+
+void* counted_allocate(size_t size, size_t alignment) {
+    ++global_allocations;
+    size = (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    void* p = std::aligned_alloc(alignment, size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+} // namespace
+
+void* operator new(size_t size) { return counted_allocate(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return counted_allocate(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment) { return counted_allocate(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return counted_allocate(size, static_cast<size_t>(alignment)); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+// Один запрос: суммы и произведения, выходящие за 64 бита, в том числе
+// начатые с нулевого аккумулятора (0 + x, 0 * x, 0 - x), и деление.
+ExactRational request(const ExactRational::allocator_type& allocator) {
+    std::mt19937_64 rng(1);
+    ExactRational sum(allocator), product(Rational(1), allocator), zero(allocator);
+    RationalSoA batch(256, allocator);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        Rational term(static_cast<int64_t>(rng() >> 4), static_cast<int64_t>(rng() >> 4) + 1);
+        batch.set(i, term);
+        ExactRational value(term, allocator);
+        if (i < 32) {
+            sum += value;
+            product *= value;
+        }
+    }
+
+    ExactRational result(allocator);
+    result = zero + sum;
+    result += zero * product;
+    result -= zero - product;
+    result += sum / product;
+    result += ExactRational(Rational(1), allocator) / product;
+    return result;
+}
+
+// Прогоняет запросы подряд и требует, чтобы после первого (прогрев:
+// рост буфера арены, заполнение пулов) глобальных выделений не было.
+template <class Setup, class Finish>
+bool run(const char* name, const ExactRational& expected, Setup setup, Finish finish) {
+    const int requests = 4;
+    bool ok = true;
+    for (int i = 0; i < requests; ++i) {
+        size_t before = global_allocations;
+        {
+            ExactRational result = request(setup());
+            if (!(result == expected)) {
+                std::printf("%s: request %d: wrong result\n", name, i);
+                ok = false;
+            }
+        }
+        finish();
+        size_t allocations = global_allocations - before;
+        if (i > 0 && allocations != 0) {
+            std::printf("%s: request %d: %zu global allocations\n", name, i, allocations);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    ExactRational expected = request({});
+    if (expected.is_inline()) {
+        std::printf("request does not leave 64 bits\n");
+        return 1;
+    }
+
+    bool ok = true;
+    RationalArena arena(1024);
+    ok &= run("arena", expected, [&] { return ExactRational::allocator_type(&arena); }, [&] { arena.reset(); });
+    ok &= run("limb_pool", expected, [] { return ExactRational::allocator_type(limb_pool()); }, [] {});
+
+    std::printf(ok ? "ok\n" : "FAILED\n");
+    return ok ? 0 : 1;
+}